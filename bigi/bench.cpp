@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "big_integer.h"
+
+// Times addition, multiplication and division for a range of operand sizes.
+// Build it once per limb width (see makefile) to compare them.
+namespace
+{
+	big_integer random_number(std::mt19937& random, size_t bits)
+	{
+		const char* symbols = "0123456789abcdef";
+		std::string hex(bits / 4, '0');
+		for (auto& c : hex)
+		{
+			c = symbols[random() % 16];
+		}
+		hex[0] = symbols[8 + random() % 8];
+
+		big_integer result;
+		from_chars(hex.data(), hex.data() + hex.size(), result, 16);
+		return result;
+	}
+
+	// Nanoseconds per call, repeating the operation for at least a fifth of a second.
+	template <typename F>
+	double measure(F operation)
+	{
+		typedef std::chrono::steady_clock clock;
+		for (size_t iterations = 1;; iterations *= 2)
+		{
+			auto start = clock::now();
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				operation();
+			}
+			double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+			if (elapsed > 0.2) return elapsed / iterations * 1e9;
+		}
+	}
+}
+
+int main()
+{
+	std::mt19937 random(42);
+	big_integer sink;
+
+	std::printf("limb bits: %d\n", limbs::limb_bits);
+	std::printf("%10s %14s %14s %14s\n", "bits", "add, ns", "mul, ns", "div, ns");
+	for (size_t bits = 64; bits <= 65536; bits *= 4)
+	{
+		big_integer a = random_number(random, bits);
+		big_integer b = random_number(random, bits);
+		big_integer c = random_number(random, 2 * bits);
+
+		double add = measure([&] { sink = a + b; });
+		double mul = measure([&] { sink = a * b; });
+		double div = measure([&] { sink = c / b; });
+		std::printf("%10zu %14.1f %14.1f %14.1f\n", bits, add, mul, div);
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include <limits>
+#include "big_accumulator.h"
+
+using limbs::limb;
+using limbs::limb_bits;
+using limbs::signed_double_limb;
+
+big_accumulator::big_accumulator()
+: carries(1, 0), pending(0)
+{
+}
+
+big_accumulator& big_accumulator::operator+=(big_integer const& a)
+{
+	if (a.small)
+	{
+		limb x = static_cast<limb>(static_cast<counter>(a.number));
+		add(&x, 1, a.number < 0, false);
+	}
+	else
+	{
+		add(a.digits.cbegin(), a.digits.size(), a.signum(), false);
+	}
+	return *this;
+}
+
+big_accumulator& big_accumulator::operator-=(big_integer const& a)
+{
+	if (a.small)
+	{
+		limb x = static_cast<limb>(static_cast<counter>(a.number));
+		add(&x, 1, a.number < 0, true);
+	}
+	else
+	{
+		add(a.digits.cbegin(), a.digits.size(), a.signum(), true);
+	}
+	return *this;
+}
+
+big_integer big_accumulator::value() const
+{
+	std::vector<limb> result;
+	signed_double_limb rest = propagate(result);
+	result.push_back(static_cast<limb>(rest));
+	result.push_back(rest < 0 ? ~limb(0) : 0);
+
+	big_integer a;
+	a.set_limbs(result.data(), result.size());
+	return a;
+}
+
+void big_accumulator::clear()
+{
+	sum.clear();
+	carries.assign(1, 0);
+	pending = 0;
+}
+
+void big_accumulator::add(limb const* a, size_t n, bool negative, bool subtract)
+{
+	if (pending == static_cast<size_t>(std::numeric_limits<counter>::max() / 2)) normalize();
+	++pending;
+
+	if (sum.size() < n)
+	{
+		sum.resize(n, 0);
+		carries.resize(n + 1, 0);
+	}
+
+	// With A the n limbs of a as an unsigned number, a = A - negative * B^n and -a = ~A + 1 - (1 - negative) * B^n.
+	limb flip = subtract ? ~limb(0) : 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		limb x = a[i] ^ flip;
+		limb s = sum[i] + x;
+		carries[i + 1] += s < x;
+		sum[i] = s;
+	}
+	if (subtract)
+	{
+		carries[0] += 1;
+		carries[n] -= !negative;
+	}
+	else
+	{
+		carries[n] -= negative;
+	}
+}
+
+void big_accumulator::add_native(std::uint64_t a, bool negative, bool subtract)
+{
+	const size_t n = 64 / limb_bits;
+	limb x[n];
+	for (size_t i = 0; i < n; ++i)
+	{
+		x[i] = static_cast<limb>(a >> (i * limb_bits));
+	}
+	add(x, n, negative, subtract);
+}
+
+signed_double_limb big_accumulator::propagate(std::vector<limb>& result) const
+{
+	result.resize(sum.size());
+	signed_double_limb carry = 0;
+	for (size_t i = 0; i < sum.size(); ++i)
+	{
+		carry += static_cast<signed_double_limb>(sum[i]) + carries[i];
+		result[i] = static_cast<limb>(carry);
+		carry >>= limb_bits;
+	}
+	return carry + carries[sum.size()];
+}
+
+void big_accumulator::normalize()
+{
+	// The rest goes into a new top limb; a negative one as B + rest there and -1 above it.
+	std::vector<limb> result;
+	signed_double_limb rest = propagate(result);
+	sum.swap(result);
+	sum.push_back(static_cast<limb>(rest));
+	carries.assign(sum.size() + 1, 0);
+	carries.back() = rest < 0 ? -1 : 0;
+	pending = 0;
+}
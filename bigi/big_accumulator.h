@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// A running sum of many numbers. An addition adds the limbs in place and only counts the carries out of each
+// limb instead of propagating them, so the sum never shrinks back or regrows between additions;
+// value() resolves the counters once.
+struct big_accumulator
+{
+	big_accumulator();
+
+	big_accumulator& operator+=(big_integer const& a);
+	big_accumulator& operator-=(big_integer const& a);
+
+	// Any native integer, unsigned 64-bit values included.
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value, big_accumulator&>::type operator+=(T a);
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value, big_accumulator&>::type operator-=(T a);
+
+	big_integer value() const;
+	void clear();
+
+private:
+	typedef std::make_signed<limbs::limb>::type counter;
+
+	// Adds or subtracts the two's complement number of n limbs a.
+	void add(limbs::limb const* a, size_t n, bool negative, bool subtract);
+	void add_native(std::uint64_t a, bool negative, bool subtract);
+	// The limbs of sum with the counters resolved; returns the rest above them.
+	limbs::signed_double_limb propagate(std::vector<limbs::limb>& result) const;
+	void normalize();
+
+	// The value is the sum of (sum[i] + carries[i]) * B^i; carries has one more entry than sum.
+	std::vector<limbs::limb> sum;
+	std::vector<counter> carries;
+	// Additions since the last normalize(); each one moves a counter by at most one.
+	size_t pending;
+};
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, big_accumulator&>::type big_accumulator::operator+=(T a)
+{
+	add_native(static_cast<std::uint64_t>(a), std::is_signed<T>::value && static_cast<std::int64_t>(a) < 0, false);
+	return *this;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, big_accumulator&>::type big_accumulator::operator-=(T a)
+{
+	add_native(static_cast<std::uint64_t>(a), std::is_signed<T>::value && static_cast<std::int64_t>(a) < 0, true);
+	return *this;
+}
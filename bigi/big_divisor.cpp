@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <stdexcept>
+#include "big_divisor.h"
+
+using limbs::limb;
+
+big_divisor::big_divisor(big_integer const& divisor)
+: divisor(divisor), b(divisor.magnitude()), single(b.size() == 1 ? b[0] : 1)
+{
+	if (b.empty()) throw std::runtime_error("division by zero");
+
+	if (b.size() > 1)
+	{
+		size_t n = b.size();
+		magnitude_type power(2 * n + 1, 0), remainder(n);
+		power[2 * n] = 1;
+		reciprocal.resize(n + 2);
+		limbs::divrem(reciprocal.data(), remainder.data(), power.data(), power.size(), b.data(), n);
+		reciprocal.resize(limbs::normalized_size(reciprocal.data(), reciprocal.size()));
+	}
+}
+
+big_integer big_divisor::div(big_integer const& a) const
+{
+	return divmod(a).first;
+}
+
+big_integer big_divisor::mod(big_integer const& a) const
+{
+	return divmod(a).second;
+}
+
+std::pair<big_integer, big_integer> big_divisor::divmod(big_integer const& a) const
+{
+	if (a.small && divisor.small) return ::divmod(a, divisor);
+
+	magnitude_type q, r;
+	divide(q, r, a.magnitude());
+
+	std::pair<big_integer, big_integer> result;
+	result.first.set_magnitude(q.data(), q.size(), a.signum() ^ divisor.signum());
+	result.second.set_magnitude(r.data(), r.size(), a.signum());
+
+	return result;
+}
+
+void big_divisor::divide(magnitude_type& q, magnitude_type& r, magnitude_type const& a) const
+{
+	size_t n = b.size();
+	if (a.size() < n)
+	{
+		q.clear();
+		r = a;
+		return;
+	}
+	if (n == 1)
+	{
+		q.resize(a.size());
+		r.assign(1, limbs::divrem_1(q.data(), a.data(), a.size(), single));
+		return;
+	}
+
+	// Long division in base B^n, with one Barrett reduction per digit.
+	size_t count = (a.size() + n - 1) / n;
+	q.assign(count * n, 0);
+	r.assign(n, 0);
+	magnitude_type x(2 * n), product, remainder;
+	for (size_t i = count; i-- > 0;)
+	{
+		size_t low = i * n;
+		size_t high = std::min(a.size(), low + n);
+		std::fill(x.begin(), x.begin() + n, 0);
+		std::copy(a.begin() + low, a.begin() + high, x.begin());
+		std::copy(r.begin(), r.end(), x.begin() + n);
+		reduce(q.data() + low, r.data(), x.data(), product, remainder);
+	}
+}
+
+void big_divisor::reduce(limb* q, limb* r, limb const* x, magnitude_type& product, magnitude_type& remainder) const
+{
+	size_t n = b.size();
+	size_t rn = reciprocal.size();
+
+	// floor(floor(x / B^(n - 1)) * reciprocal / B^(n + 1)) is at most two below the quotient, which is below B^n.
+	product.assign(n + 1 + rn, 0);
+	limbs::mul(product.data(), x + n - 1, n + 1, reciprocal.data(), rn);
+	std::copy(product.begin() + n + 1, product.begin() + 2 * n + 1, q);
+
+	limbs::mul(product.data(), q, n, b.data(), n);
+	remainder.assign(x, x + 2 * n);
+	limbs::sub(remainder.data(), remainder.data(), 2 * n, product.data(), 2 * n);
+	while (limbs::compare(remainder.data(), 2 * n, b.data(), n) >= 0)
+	{
+		limb one = 1;
+		limbs::sub(remainder.data(), remainder.data(), 2 * n, b.data(), n);
+		limbs::add(q, q, n, &one, 1);
+	}
+	std::copy(remainder.begin(), remainder.begin() + n, r);
+}
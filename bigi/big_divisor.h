@@ -0,0 +1,30 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// A divisor prepared for dividing many numbers by it: single-limb divisors keep a Moller-Granlund reciprocal,
+// longer ones a Barrett reciprocal floor(B^2n / |d|) for their n limbs.
+// Results match a / d, a % d and divmod(a, d).
+struct big_divisor
+{
+	explicit big_divisor(big_integer const& divisor);
+
+	big_integer div(big_integer const& a) const;
+	big_integer mod(big_integer const& a) const;
+	std::pair<big_integer, big_integer> divmod(big_integer const& a) const;
+
+private:
+	typedef std::vector<limbs::limb> magnitude_type;
+
+	// Magnitudes: q = a / |d|, r = a % |d|.
+	void divide(magnitude_type& q, magnitude_type& r, magnitude_type const& a) const;
+	// q and r (n limbs each) for x of 2n limbs below |d| * B^n.
+	void reduce(limbs::limb* q, limbs::limb* r, limbs::limb const* x, magnitude_type& product, magnitude_type& remainder) const;
+
+	big_integer divisor;
+	magnitude_type b;
+	limbs::limb_divisor single;
+	magnitude_type reciprocal;
+};
@@ -0,0 +1,273 @@
+#pragma once
+#include <type_traits>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// Opt-in expression templates for the fused operations of big_integer. Wrapping one factor in lazy() makes
+// a product describe itself instead of computing a temporary:
+//
+//     acc = lazy(acc) * x + y;                  // acc.set_product(acc, x), then acc += y
+//     r = lazy(a) * b - lazy(c) * d;            // r.set_product(a, b), then r.submul(c, d)
+//     r += lazy(a) * 10u;                       // r.addmul_word(a, 10)
+//
+// Products of two numbers, products of a number and an unsigned word, and their sums and differences with
+// a number or with each other are evaluated straight into the destination. Expressions hold references to
+// their operands, so they are meant to be used within the statement that builds them, not stored.
+namespace expression
+{
+	struct operand
+	{
+		big_integer const& value;
+	};
+
+	struct product
+	{
+		typedef void expression_tag;
+		typedef void product_tag;
+
+		big_integer const& a;
+		big_integer const& b;
+
+		bool aliases(big_integer const& r) const
+		{
+			return &r == &a || &r == &b;
+		}
+
+		void evaluate(big_integer& r) const
+		{
+			r.set_product(a, b);
+		}
+
+		void add_to(big_integer& r, bool subtract) const
+		{
+			if (subtract)
+			{
+				r.submul(a, b);
+			}
+			else
+			{
+				r.addmul(a, b);
+			}
+		}
+
+		operator big_integer() const
+		{
+			big_integer r;
+			evaluate(r);
+			return r;
+		}
+	};
+
+	struct word_product
+	{
+		typedef void expression_tag;
+		typedef void product_tag;
+
+		big_integer const& a;
+		limbs::limb b;
+
+		bool aliases(big_integer const& r) const
+		{
+			return &r == &a;
+		}
+
+		void evaluate(big_integer& r) const
+		{
+			if (aliases(r))
+			{
+				r.set_product(a, big_integer(b));
+			}
+			else
+			{
+				r = 0;
+				r.addmul_word(a, b);
+			}
+		}
+
+		void add_to(big_integer& r, bool subtract) const
+		{
+			if (subtract)
+			{
+				r.submul_word(a, b);
+			}
+			else
+			{
+				r.addmul_word(a, b);
+			}
+		}
+
+		operator big_integer() const
+		{
+			big_integer r;
+			evaluate(r);
+			return r;
+		}
+	};
+
+	// (-1)^negate_p * p + (-1)^negate_c * c.
+	template <typename P>
+	struct product_sum
+	{
+		typedef void expression_tag;
+
+		P p;
+		big_integer const& c;
+		bool negate_p;
+		bool negate_c;
+
+		void evaluate(big_integer& r) const
+		{
+			if (&r == &c && !(negate_c && p.aliases(r)))
+			{
+				if (negate_c) r = -std::move(r);
+				p.add_to(r, negate_p);
+				return;
+			}
+			if (&r == &c)
+			{
+				big_integer t;
+				evaluate(t);
+				r = std::move(t);
+				return;
+			}
+
+			p.evaluate(r);
+			if (negate_p) r = -std::move(r);
+			if (negate_c)
+			{
+				r -= c;
+			}
+			else
+			{
+				r += c;
+			}
+		}
+
+		operator big_integer() const
+		{
+			big_integer r;
+			evaluate(r);
+			return r;
+		}
+	};
+
+	// p + q or p - q.
+	template <typename P, typename Q>
+	struct product_pair
+	{
+		typedef void expression_tag;
+
+		P p;
+		Q q;
+		bool subtract;
+
+		void evaluate(big_integer& r) const
+		{
+			// The product written first must not overwrite an operand of the second.
+			if (!q.aliases(r))
+			{
+				p.evaluate(r);
+				q.add_to(r, subtract);
+			}
+			else if (!p.aliases(r))
+			{
+				q.evaluate(r);
+				if (subtract) r = -std::move(r);
+				p.add_to(r, false);
+			}
+			else
+			{
+				big_integer t;
+				p.evaluate(t);
+				q.add_to(t, subtract);
+				r = std::move(t);
+			}
+		}
+
+		operator big_integer() const
+		{
+			big_integer r;
+			evaluate(r);
+			return r;
+		}
+	};
+
+	// R for the product types above.
+	template <typename P, typename R, typename = void>
+	struct enable_if_product
+	{
+	};
+
+	template <typename P, typename R>
+	struct enable_if_product<P, R, typename P::product_tag>
+	{
+		typedef R type;
+	};
+
+	// Unsigned integers no wider than a limb multiply as words.
+	template <typename T>
+	struct enable_if_word : std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+		&& sizeof(T) <= sizeof(limbs::limb), word_product>
+	{
+	};
+
+	inline product operator*(operand a, operand b) { return {a.value, b.value}; }
+	inline product operator*(operand a, big_integer const& b) { return {a.value, b}; }
+	inline product operator*(big_integer const& a, operand b) { return {a, b.value}; }
+
+	template <typename T>
+	typename enable_if_word<T>::type operator*(operand a, T b) { return {a.value, b}; }
+	template <typename T>
+	typename enable_if_word<T>::type operator*(T a, operand b) { return {b.value, a}; }
+
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator+(P const& p, big_integer const& c) { return {p, c, false, false}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator+(big_integer const& c, P const& p) { return {p, c, false, false}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator-(P const& p, big_integer const& c) { return {p, c, false, true}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator-(big_integer const& c, P const& p) { return {p, c, true, false}; }
+
+	// The rvalue overloads take integers converted on the spot, which the operators of big_integer would
+	// otherwise match as well; the temporaries live until the end of the statement.
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator+(P const& p, big_integer&& c) { return {p, c, false, false}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator+(big_integer&& c, P const& p) { return {p, c, false, false}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator-(P const& p, big_integer&& c) { return {p, c, false, true}; }
+	template <typename P>
+	typename enable_if_product<P, product_sum<P>>::type operator-(big_integer&& c, P const& p) { return {p, c, true, false}; }
+
+	template <typename P, typename Q>
+	typename enable_if_product<P, typename enable_if_product<Q, product_pair<P, Q>>::type>::type operator+(P const& p, Q const& q)
+	{
+		return {p, q, false};
+	}
+
+	template <typename P, typename Q>
+	typename enable_if_product<P, typename enable_if_product<Q, product_pair<P, Q>>::type>::type operator-(P const& p, Q const& q)
+	{
+		return {p, q, true};
+	}
+
+	template <typename P>
+	typename enable_if_product<P, big_integer&>::type operator+=(big_integer& r, P const& p)
+	{
+		p.add_to(r, false);
+		return r;
+	}
+
+	template <typename P>
+	typename enable_if_product<P, big_integer&>::type operator-=(big_integer& r, P const& p)
+	{
+		p.add_to(r, true);
+		return r;
+	}
+}
+
+inline expression::operand lazy(big_integer const& a)
+{
+	return {a};
+}
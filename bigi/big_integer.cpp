@@ -1,11 +1,43 @@
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include "big_integer.h"
+#include "limb_kernels.h"
+
+using limbs::limb;
+using limbs::limb_bits;
+
+typedef std::make_signed<limb>::type signed_limb;
+
+namespace
+{
+	// Operands and products of the fused operations, kept per thread so that loops over them stop allocating.
+	struct product_scratch
+	{
+		std::vector<limb> a;
+		std::vector<limb> b;
+		std::vector<limb> product;
+	};
+
+	product_scratch& scratch()
+	{
+		thread_local product_scratch buffers;
+		return buffers;
+	}
+
+	// Grows geometrically, so that a number growing a little at a time, like the accumulator of a Horner
+	// loop, does not reallocate on every step.
+	void reserve(std::vector<limb>& buffer, size_t n)
+	{
+		if (n > buffer.capacity()) buffer.reserve(std::max(n, 2 * buffer.capacity()));
+	}
+}
 
 big_integer::big_integer()
-: small(true), number(0), digits(my_vector<std::uint32_t>())
+: small(true), number(0)
 {
 }
 
@@ -14,87 +46,127 @@ big_integer::big_integer(big_integer const& other)
 {
 }
 
+big_integer::big_integer(big_integer&& other) noexcept
+: small(other.small), number(other.number), digits(std::move(other.digits))
+{
+	other.small = true;
+	other.number = 0;
+}
+
 big_integer::big_integer(int a)
-: small(true), number(a), digits(my_vector<std::uint32_t>())
+: small(true), number(a)
 {
 }
 
-big_integer::big_integer(std::string const& str)
+big_integer::big_integer(long a)
+: big_integer(static_cast<long long>(a))
+{
+}
+
+big_integer::big_integer(long long a)
+: small(true), number(static_cast<std::int32_t>(a))
+{
+	if (a != number) set_int64(a);
+}
+
+big_integer::big_integer(unsigned a)
+: big_integer(static_cast<unsigned long long>(a))
+{
+}
+
+big_integer::big_integer(unsigned long a)
+: big_integer(static_cast<unsigned long long>(a))
+{
+}
+
+big_integer::big_integer(unsigned long long a)
+: small(true), number(static_cast<std::int32_t>(a))
+{
+	if (a > static_cast<unsigned long long>(std::numeric_limits<std::int32_t>::max())) set_words(a, 0, false);
+}
+
+#if defined(__SIZEOF_INT128__)
+big_integer::big_integer(__int128 a)
 : big_integer()
 {
-	bool negative = str.at(0) == '-';
-	for (auto it = negative ? str.begin() + 1 : str.begin(); it != str.end(); ++it)
+	set_words(static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(static_cast<unsigned __int128>(a) >> 64), a < 0);
+}
+
+big_integer::big_integer(unsigned __int128 a)
+: big_integer()
+{
+	set_words(static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(a >> 64), false);
+}
+#endif
+
+big_integer::big_integer(double a)
+: big_integer()
+{
+	if (!std::isfinite(a)) throw std::runtime_error("not a finite number");
+
+	// |a| = mantissa * 2^(exponent - 53) with a 53-bit integer mantissa.
+	int exponent;
+	double fraction = std::frexp(std::fabs(a), &exponent);
+	if (exponent <= 0) return;
+
+	std::uint64_t mantissa = static_cast<std::uint64_t>(std::ldexp(fraction, 53));
+	if (exponent < 53)
+	{
+		*this = big_integer(mantissa >> (53 - exponent));
+	}
+	else
 	{
-		*this *= 10;
-		*this += *it - '0';
+		*this = big_integer(mantissa) << (exponent - 53);
 	}
-	if (negative) *this = -*this;
+	if (a < 0) *this = -std::move(*this);
+}
+
+big_integer::big_integer(std::string const& str)
+: big_integer()
+{
+	bool negative = str.at(0) == '-';
+	size_t start = negative ? 1 : 0;
+	std::vector<limb> magnitude = limbs::from_decimal(str.data() + start, str.size() - start);
+	set_magnitude(magnitude.data(), magnitude.size(), negative);
 }
 
 
 big_integer& big_integer::operator=(big_integer const& other) &
 {
-	if (*this == other)
-		return *this;
-
 	small = other.small;
 	number = other.number;
 	digits = other.digits;
 	return *this;
 }
 
-
-big_integer& big_integer::operator+=(big_integer const& rhs) &
+big_integer& big_integer::operator=(big_integer&& other) & noexcept
 {
-	if (small && rhs.small)
-	{
-		std::uint64_t result = static_cast<std::int64_t>(number)+static_cast<std::int64_t>(rhs.number);
-		zero_setting();
-		digits.push_back(result % (1ULL << 32));
-		digits.push_back(result >> 32);
-		remove_redundancy();
-		return *this;
-	}
-
-	to_big();
-
-	big_integer b = rhs;
-	b.to_big();
+	if (this == &other) return *this;
 
-	std::uint64_t carry = 0;
-	int count = digits.size() > b.digits.size() ? digits.size() : b.digits.size();
-	for (int i = 0; i < count; ++i)
-	{
-		if (i > digits.size())
-		{
-			digits.push_back(at(i));
-		}
-
-		carry += static_cast<std::uint64_t>(digits[i]) + static_cast<std::uint64_t>(b.at(i));
+	small = other.small;
+	number = other.number;
+	digits = std::move(other.digits);
+	other.small = true;
+	other.number = 0;
+	return *this;
+}
 
-		digits[i] = static_cast<std::uint32_t>(carry % (1ULL << 32));
-		carry >>= 32;
-	}
-	remove_redundancy();
 
-	return *this;
+big_integer& big_integer::operator+=(big_integer const& rhs) &
+{
+	return add_signed(rhs, false);
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) &
 {
-	*this += -rhs;
-	return *this;
+	return add_signed(rhs, true);
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) &
 {
 	if (small && rhs.small)
 	{
-		std::uint64_t result = static_cast<std::int64_t>(number)* static_cast<std::int64_t>(rhs.number);
-		zero_setting();
-		digits.push_back(result % (1ULL << 32));
-		digits.push_back(result >> 32);
-		remove_redundancy();
+		set_int64(static_cast<std::int64_t>(number) * rhs.number);
 		return *this;
 	}
 
@@ -105,119 +177,97 @@ big_integer& big_integer::operator*=(big_integer const& rhs) &
 	a.to_big();
 	b.to_big();
 
+	// The extra top limb stays zero and keeps the product non-negative.
 	big_integer result;
 	result.to_big();
-	result.digits.insert(result.digits.cend(), a.digits.size() + b.digits.size(), 0);
-	for (auto i = 0; i < a.digits.size(); ++i)
-	{
-		std::uint64_t carry = 0;
-		for (auto j = 0; j < b.digits.size(); ++j)
-		{
-			std::uint64_t s = static_cast<std::uint64_t>(result.at(i + j)) + static_cast<std::uint64_t>(a.at(i)) * static_cast<std::uint64_t>(b.at(j)) + carry;
-			result.digits[i + j] = static_cast<std::uint32_t>(s % (1ULL << 32));
-			carry = s >> 32;
-		}
-		if (carry != 0)
-		{
-			result.digits[i + b.digits.size()] = carry;
-		}
-	}
+	result.digits.insert(result.digits.cend(), a.digits.size() + b.digits.size() + 1, 0);
+	limbs::mul(result.digits.begin(), a.digits.cbegin(), a.digits.size(), b.digits.cbegin(), b.digits.size());
 	result.remove_redundancy();
-	if (result.signum()) result.digits.push_back(0);
 
-	return *this = sign ? -result : result;
+	if (sign) result = -std::move(result);
+	return *this = std::move(result);
 }
 
-big_integer& big_integer::operator/=(big_integer const& rhs) &
+big_integer& big_integer::set_product(big_integer const& a, big_integer const& b) &
 {
-	if (rhs == 0) throw std::runtime_error("division by zero");
-
-	if (small && rhs.small)
+	if (a.small && b.small)
 	{
-		return *this = number / rhs.number;
+		set_int64(static_cast<std::int64_t>(a.number) * b.number);
+		return *this;
 	}
 
-	bool sign = signum() ^ rhs.signum();
+	bool negative;
+	std::vector<limb> const& product = multiply_magnitudes(a, b, negative);
+	set_magnitude(product.data(), product.size(), negative);
+	return *this;
+}
 
-	big_integer a = signum() ? -*this : *this;
-	big_integer b = rhs.signum() ? -rhs : rhs;
+big_integer& big_integer::addmul(big_integer const& a, big_integer const& b) &
+{
+	return add_product(a, b, false);
+}
 
-	if (a < b) return *this = 0;
+big_integer& big_integer::submul(big_integer const& a, big_integer const& b) &
+{
+	return add_product(a, b, true);
+}
 
-	int n = a.digits_count() - b.digits_count();
+big_integer& big_integer::addmul_word(big_integer const& a, limb b) &
+{
+	return add_word_product(a, b, false);
+}
 
-	big_integer result;
-	result.to_big();
-	if (b.small)
-	{
-		result.digits.insert(result.digits.cend(), a.digits.size() - 1, 0);
-		std::uint64_t dividend = 0;
-		for (int i = a.digits.size() - 1; i >= 0; --i)
-		{
-			dividend |= a.digits[i];
-			result.digits[i] = dividend / b.number;
-			dividend = (dividend % b.number) << 32;
-		}
-	}
-	else
-	{
-		result.digits.insert(result.digits.cend(), (n + 1) / 32, 0);
-		if (a < b << n)
-		{
-			n--;
-		}
-		while (a >= b)
-		{
-			a -= b << n;
-			result.set_bit(n, true);
-			while (a < b << n && n > 0)
-			{
-				n--;
-			}
-		}
-	}
-	result.remove_redundancy();
+big_integer& big_integer::submul_word(big_integer const& a, limb b) &
+{
+	return add_word_product(a, b, true);
+}
 
-	return *this = sign ? -result : result;
+big_integer& big_integer::operator/=(big_integer const& rhs) &
+{
+	return *this = divmod(*this, rhs).first;
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs)  &
 {
-	return *this = *this - rhs * (*this / rhs);
+	return *this = divmod(*this, rhs).second;
 }
 
 
 big_integer& big_integer::operator&=(big_integer const& rhs) &
 {
-	return bit_operation(std::bit_and<std::uint32_t>(), rhs);
+	return bit_operation(std::bit_and<limb>(), limbs::and_n, rhs);
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) &
 {
-	return bit_operation(std::bit_or<std::uint32_t>(), rhs);
+	return bit_operation(std::bit_or<limb>(), limbs::or_n, rhs);
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) &
 {
-	return bit_operation(std::bit_xor<std::uint32_t>(), rhs);
+	return bit_operation(std::bit_xor<limb>(), limbs::xor_n, rhs);
 }
 
 
 big_integer& big_integer::operator<<=(int rhs) &
 {
-	to_big();
-
-	int real_shift = rhs % 32;
-	if (real_shift != 0)
+	if (small && rhs < 32)
 	{
-		digits.push_back(static_cast<std::int32_t>(digits.back()) >> (32 - real_shift));
-		for (int i = static_cast<int>(digits.size()) - 2; i > 0; --i)
-		{
-			digits[i] = (digits[i] << real_shift) + (digits[i - 1] >> (32 - real_shift));
-		}
-		digits.front() <<= real_shift;
+		set_int64(static_cast<std::int64_t>(number) * (std::int64_t(1) << rhs));
+		return *this;
 	}
-	digits.insert(digits.begin(), rhs / 32, 0);
+
+	to_big();
+
+	size_t limb_shift = rhs / limb_bits;
+	int bit_shift = rhs % limb_bits;
+	size_t n = digits.size();
+	limb extension = signum() ? -1 : 0;
+
+	digits.resize(n + limb_shift + 1);
+	limb out = limbs::lshift(digits.begin() + limb_shift, digits.cbegin(), n, bit_shift);
+	digits.back() = bit_shift == 0 ? extension : (extension << bit_shift) | out;
+	std::fill(digits.begin(), digits.begin() + limb_shift, 0);
 
 	remove_redundancy();
 
@@ -227,57 +277,76 @@ big_integer& big_integer::operator<<=(int rhs) &
 
 big_integer& big_integer::operator>>=(int rhs) &
 {
-	to_big();
-
-	digits.erase(digits.cbegin(), digits.cbegin() + rhs / 32);
-
-	int real_shift = rhs % 32;
-	if (real_shift != 0)
+	if (small)
 	{
-		for (auto it = digits.begin(); it != digits.end(); ++it)
-		{
-			if (it != digits.begin())
-			{
-				std::uint32_t temp = *it % (1 << real_shift);
-				*(it - 1) += temp << (32 - real_shift);
-			}
-			if (it + 1 == digits.end())
-			{
-				*it = static_cast<std::int32_t> (*it) >> real_shift;
-				continue;
-			}
-			*it >>= real_shift;
-		}
+		number >>= std::min(rhs, 31);
+		return *this;
 	}
+
+	size_t limb_shift = rhs / limb_bits;
+	int bit_shift = rhs % limb_bits;
+	size_t n = digits.size();
+	limb extension = signum() ? -1 : 0;
+	if (limb_shift >= n) return *this = signum() ? -1 : 0;
+
+	limbs::rshift(digits.begin(), digits.cbegin() + limb_shift, n - limb_shift, bit_shift);
+	digits.resize(n - limb_shift);
+	if (bit_shift != 0) digits.back() |= extension << (limb_bits - bit_shift);
+
 	remove_redundancy();
 
 	return *this;
 }
 
 
-big_integer big_integer::operator+() const
+big_integer big_integer::operator+() const&
 {
 	return *this;
 }
 
-big_integer big_integer::operator-() const
+big_integer big_integer::operator+() &&
 {
-	if (small) return big_integer(-number);
+	return std::move(*this);
+}
+
+big_integer big_integer::operator-() const&
+{
+	return -big_integer(*this);
+}
+
+big_integer big_integer::operator-() &&
+{
+	if (small && number != std::numeric_limits<std::int32_t>::min())
+	{
+		number = -number;
+		return std::move(*this);
+	}
 
-	return ~*this + 1;
+	// The extension limb makes room for negating the most negative value of the current length.
+	to_big();
+	digits.push_back(signum() ? -1 : 0);
+	limbs::negate(digits.begin(), digits.cbegin(), digits.size());
+	remove_redundancy();
+
+	return std::move(*this);
 }
 
-big_integer big_integer::operator~() const
+big_integer big_integer::operator~() const&
 {
-	if (small) return big_integer(~number);
+	return ~big_integer(*this);
+}
 
-	big_integer result = *this;
-	for (auto it = result.digits.begin(); it != result.digits.end(); ++it)
+big_integer big_integer::operator~() &&
+{
+	if (small)
 	{
-		*it = ~*it;
+		number = ~number;
+		return std::move(*this);
 	}
 
-	return result;
+	limbs::bitwise_map(digits.begin(), digits.cbegin(), digits.size(), ~limb(0), 0);
+
+	return std::move(*this);
 }
 
 
@@ -320,134 +389,838 @@ bool operator!=(big_integer const& a, big_integer const& b)
 }
 
 
-bool operator<(big_integer const& a, big_integer const& b)
+int compare(big_integer const& a, big_integer const& b)
 {
-	if (a.small && b.small) return a.number < b.number;
-	if (!a.signum() && b.signum()) return false;
-	if (a.signum() && !b.signum()) return true;
-	if (a.signum() && b.signum())
+	if (a.small && b.small) return (a.number > b.number) - (a.number < b.number);
+
+	bool negative = a.signum();
+	if (negative != b.signum()) return negative ? -1 : 1;
+
+	// Both are as short as they can be, small ones shortest: of two numbers of one sign the longer one
+	// lies further from zero, and two's complement limbs of the same length compare as unsigned.
+	size_t an = a.small ? 0 : a.digits.size();
+	size_t bn = b.small ? 0 : b.digits.size();
+	if (an != bn) return (an < bn) == negative ? 1 : -1;
+	for (size_t i = an; i-- > 0;)
 	{
-		if (a.small) return false;
-		if (b.small) return true;
-		if (a.digits.size() > b.digits.size()) return true;
-		if (a.digits.size() < b.digits.size()) return false;
-		return !std::lexicographical_compare(a.digits.crbegin(), a.digits.crend(), b.digits.crbegin(), b.digits.crend());
+		if (a.digits[i] != b.digits[i]) return a.digits[i] < b.digits[i] ? -1 : 1;
 	}
-	if (a.small) return true;
-	if (b.small) return false;
-	if (a.digits.size() < b.digits.size()) return true;
-	if (a.digits.size() > b.digits.size()) return false;
-	return std::lexicographical_compare(a.digits.crbegin(), a.digits.crend(), b.digits.crbegin(), b.digits.crend());
+	return 0;
+}
+
+bool operator<(big_integer const& a, big_integer const& b)
+{
+	return compare(a, b) < 0;
 }
 
 bool operator>(big_integer const& a, big_integer const& b)
 {
-	return b < a;
+	return compare(a, b) > 0;
 }
 
 bool operator<=(big_integer const& a, big_integer const& b)
 {
-	return a < b || a == b;
+	return compare(a, b) <= 0;
 }
 
 bool operator>=(big_integer const& a, big_integer const& b)
 {
-	return a > b || a == b;
+	return compare(a, b) >= 0;
+}
+
+size_t bit_length(big_integer const& a)
+{
+	// The two's complement width less the sign bit, one more for the negated powers of two.
+	size_t width = a.digits_count() - 1;
+	if (a.signum() && countr_zero(a) == width) ++width;
+	return width;
+}
+
+size_t popcount(big_integer const& a)
+{
+	if (a.small)
+	{
+		limb value = a.number < 0 ? 0 - static_cast<limb>(a.number) : static_cast<limb>(a.number);
+		return limbs::popcount(value);
+	}
+
+	// Negative numbers are negated limb by limb as ~x + 1.
+	bool negative = a.signum();
+	limb carry = negative ? 1 : 0;
+	size_t result = 0;
+	for (size_t i = 0; i < a.digits.size(); ++i)
+	{
+		limb x = a.digits[i];
+		if (negative)
+		{
+			x = ~x + carry;
+			carry = carry != 0 && x == 0 ? 1 : 0;
+		}
+		result += limbs::popcount(x);
+	}
+	return result;
+}
+
+size_t countr_zero(big_integer const& a)
+{
+	if (a.small) return a.number == 0 ? 0 : limbs::trailing_zeros(static_cast<limb>(a.number));
+
+	// Negation keeps the low zeros, so the limbs of a serve for -a as well.
+	size_t i = 0;
+	while (a.digits[i] == 0)
+	{
+		++i;
+	}
+	return i * limb_bits + limbs::trailing_zeros(a.digits[i]);
 }
 
 
 big_integer operator+(big_integer a, big_integer const& b)
 {
-	return a += b;
+	a += b;
+	return a;
+}
+
+big_integer operator+(big_integer const& a, big_integer&& b)
+{
+	b += a;
+	return std::move(b);
 }
 
 big_integer operator-(big_integer a, big_integer const& b)
 {
-	return a -= b;
+	a -= b;
+	return a;
 }
 
 big_integer operator*(big_integer a, big_integer const& b)
 {
-	return a *= b;
+	a *= b;
+	return a;
+}
+
+big_integer operator*(big_integer const& a, big_integer&& b)
+{
+	b *= a;
+	return std::move(b);
 }
 
 big_integer operator/(big_integer a, big_integer const& b)
 {
-	return a /= b;
+	a /= b;
+	return a;
 }
 
 big_integer operator%(big_integer a, big_integer const& b)
 {
-	return a %= b;
+	a %= b;
+	return a;
 }
 
 
 big_integer operator&(big_integer a, big_integer const& b)
 {
-	return a &= b;
+	a &= b;
+	return a;
+}
+
+big_integer operator&(big_integer const& a, big_integer&& b)
+{
+	b &= a;
+	return std::move(b);
 }
 
 big_integer operator|(big_integer a, big_integer const& b)
 {
-	return a |= b;
+	a |= b;
+	return a;
+}
+
+big_integer operator|(big_integer const& a, big_integer&& b)
+{
+	b |= a;
+	return std::move(b);
 }
 
 big_integer operator^(big_integer a, big_integer const& b)
 {
-	return a ^= b;
+	a ^= b;
+	return a;
+}
+
+big_integer operator^(big_integer const& a, big_integer&& b)
+{
+	b ^= a;
+	return std::move(b);
 }
 
 
 big_integer operator<<(big_integer a, int b)
 {
-	return a <<= b;
+	a <<= b;
+	return a;
 }
 
 big_integer operator>>(big_integer a, int b)
 {
-	return a >>= b;
+	a >>= b;
+	return a;
+}
+
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b)
+{
+	if (b == 0) throw std::runtime_error("division by zero");
+
+	if (a.small && b.small)
+	{
+		std::int64_t x = a.number;
+		std::int64_t y = b.number;
+		std::int64_t q = x / y;
+		if (q == static_cast<std::int32_t>(q)) return std::make_pair(big_integer(static_cast<int>(q)), big_integer(static_cast<int>(x % y)));
+
+		// Only INT_MIN / -1 leaves the small range.
+		limb magnitude = static_cast<limb>(q);
+		big_integer quotient;
+		quotient.set_magnitude(&magnitude, 1, false);
+		return std::make_pair(quotient, big_integer());
+	}
+
+	// After to_big() the limbs of x and y are the magnitudes of a and b.
+	big_integer x = a.signum() ? -a : a;
+	big_integer y = b.signum() ? -b : b;
+	x.to_big();
+	y.to_big();
+
+	size_t an = limbs::normalized_size(x.digits.cbegin(), x.digits.size());
+	size_t bn = limbs::normalized_size(y.digits.cbegin(), y.digits.size());
+	if (limbs::compare(x.digits.cbegin(), an, y.digits.cbegin(), bn) < 0) return std::make_pair(big_integer(), a);
+
+	std::vector<limb> q(an - bn + 1), r(bn);
+	limbs::divrem(q.data(), r.data(), x.digits.cbegin(), an, y.digits.cbegin(), bn);
+
+	std::pair<big_integer, big_integer> result;
+	result.first.set_magnitude(q.data(), q.size(), a.signum() ^ b.signum());
+	result.second.set_magnitude(r.data(), r.size(), a.signum());
+
+	return result;
+}
+
+big_integer gcd(big_integer const& a, big_integer const& b)
+{
+	std::vector<limb> x = a.magnitude();
+	std::vector<limb> y = b.magnitude();
+	if (x.empty() && y.empty()) return 0;
+
+	std::vector<limb> g(std::max(x.size(), y.size()));
+	size_t size = limbs::gcd(g.data(), x.data(), x.size(), y.data(), y.size());
+
+	big_integer result;
+	result.set_magnitude(g.data(), size, false);
+	return result;
 }
 
+big_integer lcm(big_integer const& a, big_integer const& b)
+{
+	if (a == 0 || b == 0) return 0;
+
+	big_integer result = a / gcd(a, b) * b;
+	return result.signum() ? -std::move(result) : result;
+}
+
+big_integer isqrt(big_integer const& a)
+{
+	if (a.signum()) throw std::runtime_error("square root of a negative number");
+
+	std::vector<limb> m = a.magnitude();
+	if (m.empty()) return 0;
+
+	// Newton's iteration decreases to floor(sqrt(a)) from any start above it. The start comes from the
+	// square root of the leading (at most 52) bits, with an even number of bits below them.
+	size_t bits = m.size() * limb_bits - limbs::leading_zeros(m.back());
+	size_t shift = bits > 52 ? (bits - 51) & ~size_t(1) : 0;
+	std::uint64_t top = 0;
+	for (size_t i = bits; i-- > shift;)
+	{
+		top = top << 1 | ((m[i / limb_bits] >> (i % limb_bits)) & 1);
+	}
+	int root = static_cast<int>(std::sqrt(static_cast<double>(top))) + 2;
+
+	big_integer x = big_integer(root) << static_cast<int>(shift / 2);
+	for (;;)
+	{
+		big_integer y = (x + a / x) >> 1;
+		if (!(y < x)) return x;
+		x = std::move(y);
+	}
+}
+
+big_integer pow(big_integer const& base, unsigned exponent)
+{
+	if (exponent == 0) return 1;
+
+	std::vector<limb> b = base.magnitude();
+	if (b.empty()) return 0;
+
+	// Left to right: square for every bit below the top one and multiply by the base for the ones.
+	std::vector<limb> result = b, square;
+	int bit = std::numeric_limits<unsigned>::digits - 1;
+	while ((exponent >> bit) == 0)
+	{
+		--bit;
+	}
+	while (bit-- > 0)
+	{
+		square.resize(2 * result.size());
+		limbs::sqr(square.data(), result.data(), result.size());
+		square.resize(limbs::normalized_size(square.data(), square.size()));
+		if ((exponent >> bit) & 1)
+		{
+			result.resize(square.size() + b.size());
+			limbs::mul(result.data(), square.data(), square.size(), b.data(), b.size());
+			result.resize(limbs::normalized_size(result.data(), result.size()));
+		}
+		else
+		{
+			std::swap(result, square);
+		}
+	}
+
+	big_integer power;
+	power.set_magnitude(result.data(), result.size(), base.signum() && (exponent & 1) != 0);
+	return power;
+}
+
+big_integer mod_inverse(big_integer const& a, big_integer const& m)
+{
+	if (m == 0) throw std::runtime_error("division by zero");
+
+	big_integer modulus = m.signum() ? -m : m;
+	if (modulus == 1) return 0;
+
+	big_integer reduced = a % modulus;
+	if (reduced.signum()) reduced += modulus;
+
+	std::vector<limb> x = reduced.magnitude();
+	std::vector<limb> y = modulus.magnitude();
+	std::vector<limb> r(y.size());
+	if (!limbs::mod_inverse(r.data(), x.data(), x.size(), y.data(), y.size())) throw std::runtime_error("no modular inverse");
+
+	big_integer result;
+	result.set_magnitude(r.data(), r.size(), false);
+	return result;
+}
 
 std::string to_string(big_integer const& a)
 {
 	if (a.small) return std::to_string(a.number);
 
-	std::ostringstream result;
-	std::vector<std::uint32_t> result_vector;
-	big_integer temp = a;
+	// After to_big() the limbs of the negation are the magnitude.
+	big_integer magnitude = a.signum() ? -a : a;
+	magnitude.to_big();
 
-	if (a.signum())
+	std::string digits = limbs::to_decimal(magnitude.digits.cbegin(), magnitude.digits.size());
+	return a.signum() ? "-" + digits : digits;
+}
+
+namespace
+{
+	// Bits per digit of a power-of-two base, 0 for base 10 and -1 for unsupported bases.
+	int radix_bits(int base)
 	{
-		result << "-";
-		temp = -temp;
+		if (base == 10) return 0;
+		for (int bits = 1; bits <= 5; ++bits)
+		{
+			if (base == 1 << bits) return bits;
+		}
+		return -1;
 	}
 
-	const int base = static_cast<int>(1e9);
+	int digit_value(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+		return std::numeric_limits<int>::max();
+	}
 
-	do
+	int stream_base(std::ios_base const& s)
 	{
-		big_integer t = temp % base;
-		result_vector.push_back(t.small ? t.number : t.digits[0]);
-		temp /= base;
-	} while (temp > 0);
+		switch (s.flags() & std::ios_base::basefield)
+		{
+		case std::ios_base::hex:
+			return 16;
+		case std::ios_base::oct:
+			return 8;
+		default:
+			return 10;
+		}
+	}
 
-	for (auto it = result_vector.crbegin(); it != result_vector.crend(); ++it)
+	// Limbs of the magnitude of a two's complement number, computed on the fly so that
+	// negative values need no negated copy.
+	struct magnitude_reader
 	{
-		if (it == result_vector.crbegin())
+		magnitude_reader(limb const* limbs, size_t size)
+		: limbs(limbs), negative((limbs[size - 1] >> (limb_bits - 1)) != 0), lowest_nonzero(0), size(size)
 		{
-			result << *it;
-			continue;
+			while (lowest_nonzero < size && limbs[lowest_nonzero] == 0)
+			{
+				++lowest_nonzero;
+			}
+			while (this->size > 0 && (*this)[this->size - 1] == 0)
+			{
+				--this->size;
+			}
+		}
+
+		limb operator[](size_t i) const
+		{
+			if (!negative) return limbs[i];
+			if (i < lowest_nonzero) return 0;
+			return i == lowest_nonzero ? 0 - limbs[i] : ~limbs[i];
+		}
+
+		limb const* limbs;
+		bool negative;
+		size_t lowest_nonzero;
+		size_t size;
+	};
+
+	// Decimal conversion of magnitudes up to this size runs on stack buffers.
+	const size_t decimal_stack_bits = 4096;
+
+	// The limbs big_integer keeps inline. A digit takes less than 10/3 bits, so numbers of up to
+	// inline_decimal_digits digits leave the top bit of that many limbs clear and fit without an extension limb.
+	const size_t inline_limbs = 256 / limb_bits;
+	const size_t inline_decimal_digits = (inline_limbs * limb_bits - 1) * 3 / 10;
+
+	to_chars_result to_chars_power_of_two(char* first, char* last, magnitude_reader const& magnitude, int bits)
+	{
+		const char* symbols = "0123456789abcdefghijklmnopqrstuv";
+
+		size_t n = magnitude.size;
+		size_t length = n == 0 ? 1 : (n * limb_bits - limbs::leading_zeros(magnitude[n - 1]) + bits - 1) / bits;
+		if (static_cast<size_t>(last - first) < length + magnitude.negative) return { last, std::errc::value_too_large };
+
+		if (magnitude.negative) *first++ = '-';
+		for (size_t digit = length; digit-- > 0;)
+		{
+			size_t position = digit * bits;
+			size_t index = position / limb_bits;
+			int offset = position % limb_bits;
+
+			limb value = n == 0 ? 0 : magnitude[index] >> offset;
+			if (offset + bits > limb_bits && index + 1 < n)
+			{
+				value |= magnitude[index + 1] << (limb_bits - offset);
+			}
+			*first++ = symbols[value & ((1u << bits) - 1)];
+		}
+		return { first, std::errc() };
+	}
+}
+
+to_chars_result to_chars(char* first, char* last, big_integer const& value, int base)
+{
+	int bits = radix_bits(base);
+	if (bits < 0) return { first, std::errc::invalid_argument };
+
+	limb small_limb = value.number;
+	limb const* data = value.small ? &small_limb : value.digits.cbegin();
+	size_t size = value.small ? 1 : value.digits.size();
+	magnitude_reader magnitude(data, size);
+	if (bits != 0) return to_chars_power_of_two(first, last, magnitude, bits);
+
+	size_t n = magnitude.size;
+	if (n <= decimal_stack_bits / limb_bits)
+	{
+		limb scratch[decimal_stack_bits / limb_bits];
+		char digits[decimal_stack_bits / 32 * 10 + 2];
+		for (size_t i = 0; i < n; ++i)
+		{
+			scratch[i] = magnitude[i];
+		}
+		char* end = digits + sizeof(digits);
+		char* begin = limbs::to_decimal_backward(scratch, n, end);
+
+		if (static_cast<size_t>(last - first) < static_cast<size_t>(end - begin) + magnitude.negative) return { last, std::errc::value_too_large };
+		if (magnitude.negative) *first++ = '-';
+		return { std::copy(begin, end, first), std::errc() };
+	}
+
+	// Longer numbers go through the divide-and-conquer conversion, which allocates: for the magnitude of a
+	// negative number, and for the digits when the buffer may be too short for them.
+	std::vector<limb> negated;
+	if (magnitude.negative)
+	{
+		negated.resize(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			negated[i] = magnitude[i];
 		}
-		result << std::setfill('0') << std::setw(9) << *it;
+		data = negated.data();
+	}
+
+	if (static_cast<size_t>(last - first) >= limbs::decimal_digits_bound(n) + magnitude.negative)
+	{
+		if (magnitude.negative) *first++ = '-';
+		return { limbs::to_decimal(data, n, first), std::errc() };
 	}
 
-	return result.str();
+	std::string digits = limbs::to_decimal(data, n);
+	if (static_cast<size_t>(last - first) < digits.size() + magnitude.negative) return { last, std::errc::value_too_large };
+	if (magnitude.negative) *first++ = '-';
+	return { std::copy(digits.cbegin(), digits.cend(), first), std::errc() };
+}
+
+from_chars_result from_chars(char const* first, char const* last, big_integer& value, int base)
+{
+	int bits = radix_bits(base);
+	if (bits < 0) return { first, std::errc::invalid_argument };
+
+	char const* it = first;
+	bool negative = it != last && *it == '-';
+	if (negative) ++it;
+
+	char const* begin = it;
+	while (it != last && digit_value(*it) < base)
+	{
+		++it;
+	}
+	if (it == begin) return { first, std::errc::invalid_argument };
+
+	// Magnitudes that fit the inline storage are assembled on the stack; only longer ones allocate.
+	size_t count = it - begin;
+	limb stack[inline_limbs];
+	std::vector<limb> heap;
+	limb* magnitude = stack;
+	size_t size;
+	if (bits == 0)
+	{
+		if (count <= inline_decimal_digits)
+		{
+			size = limbs::from_decimal(begin, count, stack);
+		}
+		else
+		{
+			heap = limbs::from_decimal(begin, count);
+			magnitude = heap.data();
+			size = heap.size();
+		}
+	}
+	else
+	{
+		size = (count * bits + limb_bits - 1) / limb_bits;
+		if (size > inline_limbs)
+		{
+			heap.resize(size);
+			magnitude = heap.data();
+		}
+		std::fill(magnitude, magnitude + size, 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			limb digit = digit_value(it[-1 - static_cast<std::ptrdiff_t>(i)]);
+			size_t position = i * bits;
+			int offset = position % limb_bits;
+			magnitude[position / limb_bits] |= digit << offset;
+			if (offset + bits > limb_bits)
+			{
+				magnitude[position / limb_bits + 1] |= digit >> (limb_bits - offset);
+			}
+		}
+	}
+	value.set_magnitude(magnitude, size, negative);
+
+	return { it, std::errc() };
+}
+
+namespace
+{
+	const size_t word_bytes = 8;
+	const size_t limbs_per_word = 64 / limb_bits;
+
+	void store_word(char* out, std::uint64_t word)
+	{
+		for (size_t i = 0; i < word_bytes; ++i)
+		{
+			out[i] = static_cast<char>(word >> (8 * i));
+		}
+	}
+
+	std::uint64_t load_word(char const* in)
+	{
+		std::uint64_t word = 0;
+		for (size_t i = 0; i < word_bytes; ++i)
+		{
+			word |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+		}
+		return word;
+	}
+}
+
+size_t serialized_size(big_integer const& value)
+{
+	return word_bytes * (1 + (value.magnitude().size() + limbs_per_word - 1) / limbs_per_word);
+}
+
+to_chars_result serialize(char* first, char* last, big_integer const& value)
+{
+	std::vector<limb> magnitude = value.magnitude();
+	size_t words = (magnitude.size() + limbs_per_word - 1) / limbs_per_word;
+	if (static_cast<size_t>(last - first) < word_bytes * (words + 1)) return { last, std::errc::value_too_large };
+
+	magnitude.resize(words * limbs_per_word, 0);
+	store_word(first, static_cast<std::uint64_t>(words) << 1 | (value.signum() ? 1 : 0));
+	for (size_t i = 0; i < words; ++i)
+	{
+		std::uint64_t word = 0;
+		for (size_t j = 0; j < limbs_per_word; ++j)
+		{
+			word |= static_cast<std::uint64_t>(magnitude[i * limbs_per_word + j]) << (j * limb_bits);
+		}
+		store_word(first + word_bytes * (i + 1), word);
+	}
+	return { first + word_bytes * (words + 1), std::errc() };
+}
+
+from_chars_result deserialize(char const* first, char const* last, big_integer& value)
+{
+	size_t words;
+	bool negative;
+	from_chars_result result = read_record_header(first, last, words, negative);
+	if (result.ec != std::errc()) return result;
+
+	std::vector<limb> magnitude(words * limbs_per_word);
+	for (size_t i = 0; i < words; ++i)
+	{
+		std::uint64_t word = load_word(first + word_bytes * (i + 1));
+		for (size_t j = 0; j < limbs_per_word; ++j)
+		{
+			magnitude[i * limbs_per_word + j] = static_cast<limb>(word >> (j * limb_bits));
+		}
+	}
+	value.set_magnitude(magnitude.data(), magnitude.size(), negative);
+	return result;
+}
+
+from_chars_result read_record_header(char const* first, char const* last, size_t& words, bool& negative)
+{
+	size_t available = static_cast<size_t>(last - first) / word_bytes;
+	if (available == 0) return { first, std::errc::invalid_argument };
+
+	std::uint64_t header = load_word(first);
+	negative = (header & 1) != 0;
+	if ((header >> 1) > available - 1) return { first, std::errc::invalid_argument };
+	words = static_cast<size_t>(header >> 1);
+
+	// Only the canonical record of each number is accepted: no leading zero word and no negative zero.
+	if (words == 0 ? negative : load_word(first + word_bytes * words) == 0) return { first, std::errc::invalid_argument };
+	return { first + word_bytes * (words + 1), std::errc() };
 }
 
 std::ostream& operator<<(std::ostream& s, big_integer const& a)
 {
-	return s << to_string(a);
+	int base = stream_base(s);
+	if (base == 10) return s << to_string(a);
+
+	size_t size = a.small ? 1 : a.digits.size();
+	std::string text(size * limb_bits / radix_bits(base) + 2, '0');
+	text.resize(to_chars(&text[0], &text[0] + text.size(), a, base).ptr - &text[0]);
+	return s << text;
+}
+
+std::istream& operator>>(std::istream& s, big_integer& a)
+{
+	std::istream::sentry sentry(s);
+	if (!sentry) return s;
+
+	typedef std::istream::traits_type traits;
+	std::streambuf* buffer = s.rdbuf();
+	int base = stream_base(s);
+
+	int c = buffer->sgetc();
+	bool negative = c == '-';
+	if (c == '-' || c == '+') c = buffer->snextc();
+
+	// Decimal digits are folded into chunks of decimal_base_digits as they arrive; other bases are collected first.
+	std::vector<limb> chunks;
+	limb chunk = 0;
+	limb chunk_scale = 1;
+	std::string text;
+	size_t count = 0;
+	for (; !traits::eq_int_type(c, traits::eof()) && digit_value(traits::to_char_type(c)) < base; c = buffer->snextc(), ++count)
+	{
+		if (base != 10)
+		{
+			text += traits::to_char_type(c);
+			continue;
+		}
+		chunk = chunk * 10 + digit_value(traits::to_char_type(c));
+		chunk_scale *= 10;
+		if (chunk_scale == limbs::decimal_base)
+		{
+			chunks.push_back(chunk);
+			chunk = 0;
+			chunk_scale = 1;
+		}
+	}
+	if (traits::eq_int_type(c, traits::eof())) s.setstate(std::ios_base::eofbit);
+	if (count == 0)
+	{
+		s.setstate(std::ios_base::failbit);
+		return s;
+	}
+
+	if (base != 10)
+	{
+		from_chars(text.data(), text.data() + text.size(), a, base);
+		if (negative) a = -std::move(a);
+		return s;
+	}
+
+	std::vector<limb> magnitude = limbs::from_decimal_chunks(chunks.data(), chunks.size());
+	magnitude.push_back(0);
+	magnitude.back() = limbs::mul_1(magnitude.data(), magnitude.data(), magnitude.size() - 1, chunk_scale);
+	magnitude.push_back(limbs::add(magnitude.data(), magnitude.data(), magnitude.size(), &chunk, 1));
+	a.set_magnitude(magnitude.data(), magnitude.size(), negative);
+
+	return s;
+}
+
+size_t std::hash<big_integer>::operator()(big_integer const& a) const
+{
+	// Every value has a single representation, so equal numbers hash alike. Each limb is folded in with the
+	// finalizer of splitmix64.
+	size_t n = a.small ? 1 : a.digits.size();
+	std::uint64_t result = n;
+	for (size_t i = 0; i < n; ++i)
+	{
+		result ^= a.small ? static_cast<limb>(static_cast<signed_limb>(a.number)) : a.digits[i];
+		result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9ull;
+		result = (result ^ (result >> 27)) * 0x94d049bb133111ebull;
+		result ^= result >> 31;
+	}
+	return static_cast<size_t>(result);
+}
+
+big_integer& big_integer::add_signed(big_integer const& rhs, bool subtract)
+{
+	if (small && rhs.small)
+	{
+		std::int64_t result = subtract ? static_cast<std::int64_t>(number) - rhs.number : static_cast<std::int64_t>(number) + rhs.number;
+		if (result == static_cast<std::int32_t>(result))
+		{
+			number = static_cast<std::int32_t>(result);
+			return *this;
+		}
+		set_int64(result);
+		return *this;
+	}
+
+	if (this == &rhs)
+	{
+		if (subtract) return *this = 0;
+		return add_signed(big_integer(rhs), false);
+	}
+
+	limb single = rhs.number;
+	limb const* b = rhs.small ? &single : rhs.digits.cbegin();
+	size_t bn = rhs.small ? 1 : rhs.digits.size();
+	return add_limbs(b, bn, subtract);
+}
+
+big_integer& big_integer::add_limbs(limb const* b, size_t bn, bool subtract)
+{
+	// One limb more than the longer operand holds any overflow into the sign.
+	to_big();
+	limb extension = signum() ? -1 : 0;
+	digits.resize(std::max(digits.size(), bn) + 1, extension);
+	if (subtract)
+	{
+		limbs::sub_signed(digits.begin(), digits.cbegin(), digits.size(), b, bn);
+	}
+	else
+	{
+		limbs::add_signed(digits.begin(), digits.cbegin(), digits.size(), b, bn);
+	}
+	remove_redundancy();
+
+	return *this;
+}
+
+big_integer& big_integer::add_product(big_integer const& a, big_integer const& b, bool subtract)
+{
+	if (a.small && b.small)
+	{
+		return add_signed(big_integer(static_cast<std::int64_t>(a.number) * b.number), subtract);
+	}
+
+	bool negative;
+	std::vector<limb> const& product = multiply_magnitudes(a, b, negative);
+	return add_limbs(product.data(), product.size(), subtract != negative);
+}
+
+big_integer& big_integer::add_word_product(big_integer const& a, limb b, bool subtract)
+{
+	// A non-negative a is read in place unless it is this number, which is about to change.
+	std::vector<limb>& buffer = scratch().a;
+	limb const* x = a.digits.cbegin();
+	size_t n = a.digits.size();
+	if (a.small || a.signum() || &a == this)
+	{
+		a.magnitude(buffer);
+		x = buffer.data();
+		n = buffer.size();
+	}
+	if (n == 0 || b == 0) return *this;
+	subtract = subtract != a.signum();
+
+	// Room for the product and a sign limb; the result is exact in two's complement at this width.
+	to_big();
+	digits.resize(std::max(digits.size(), n + 1) + 1, signum() ? ~limb(0) : 0);
+	limb high[2] = {0, 0};
+	if (subtract)
+	{
+		high[0] = limbs::submul_1(digits.begin(), x, n, b);
+		limbs::sub_signed(digits.begin() + n, digits.cbegin() + n, digits.size() - n, high, 2);
+	}
+	else
+	{
+		high[0] = limbs::addmul_1(digits.begin(), x, n, b);
+		limbs::add_signed(digits.begin() + n, digits.cbegin() + n, digits.size() - n, high, 2);
+	}
+	remove_redundancy();
+
+	return *this;
+}
+
+std::vector<limb> const& big_integer::multiply_magnitudes(big_integer const& a, big_integer const& b, bool& negative)
+{
+	product_scratch& buffers = scratch();
+	negative = a.signum() != b.signum();
+	a.magnitude(buffers.a);
+	if (&a != &b) b.magnitude(buffers.b);
+	std::vector<limb> const& x = buffers.a;
+	std::vector<limb> const& y = &a == &b ? buffers.a : buffers.b;
+
+	std::vector<limb>& product = buffers.product;
+	if (x.empty() || y.empty())
+	{
+		product.assign(1, 0);
+		return product;
+	}
+	reserve(product, x.size() + y.size() + 1);
+	product.assign(x.size() + y.size() + 1, 0);
+	if (&a == &b)
+	{
+		limbs::sqr(product.data(), x.data(), x.size());
+	}
+	else
+	{
+		limbs::mul(product.data(), x.data(), x.size(), y.data(), y.size());
+	}
+	return product;
 }
 
 void big_integer::to_big()
@@ -463,49 +1236,47 @@ void big_integer::to_big()
 bool big_integer::signum() const
 {
 	if (small) return number < 0;
-	return at(digits.size()) == -1;
+	return at(digits.size()) == ~limb(0);
 }
 
 
-std::uint32_t big_integer::at(size_t index) const
+limb big_integer::at(size_t index) const
 {
 	if (index >= digits.size())
 	{
-		return (digits.back() >> 31 & 1) == 1 ? -1 : 0;
+		return (digits.back() >> (limb_bits - 1) & 1) == 1 ? -1 : 0;
 	}
 	return digits[index];
 }
 
-size_t big_integer::digits_count() const
+std::vector<limb> big_integer::magnitude() const
 {
-	size_t result = small ? 0 : (digits.size() - 1) * 32;
-	std::uint32_t x = small ? number : digits.back();
-
-	if (x == 0 || x == -1)
-	{
-		return result + 1;
-	}
-
-	result += 32;
+	std::vector<limb> result;
+	magnitude(result);
+	return result;
+}
 
-	for (auto i = 31; i >= 0 && (x >> 31) == ((x >> i) & 1); --i)
+void big_integer::magnitude(std::vector<limb>& result) const
+{
+	if (small)
 	{
-		--result;
+		limb value = number < 0 ? 0 - static_cast<limb>(number) : static_cast<limb>(number);
+		result.assign(value == 0 ? 0 : 1, value);
+		return;
 	}
 
-	return result + 1;
+	reserve(result, digits.size());
+	result.assign(digits.cbegin(), digits.cend());
+	if (signum()) limbs::negate(result.data(), result.data(), result.size());
+	result.resize(limbs::normalized_size(result.data(), result.size()));
 }
 
-void big_integer::set_bit(size_t which, bool value)
+size_t big_integer::digits_count() const
 {
-	if (value)
-	{
-		digits[which / 32] |= 1 << (which % 32);
-	}
-	else
-	{
-		digits[which / 32] &= ~(1 << (which % 32));
-	}
+	// The bits below the copies of the sign bit at the top, plus one sign bit.
+	limb x = small ? number : digits.back();
+	size_t below = small ? 0 : (digits.size() - 1) * limb_bits;
+	return below + limb_bits - limbs::leading_zeros(signum() ? ~x : x) + 1;
 }
 
 void big_integer::remove_redundancy()
@@ -513,7 +1284,7 @@ void big_integer::remove_redundancy()
 	if (small) return;
 
 	bool sign = signum();
-	while (digits.size() > 1 && (digits.back() == 0 || digits.back() == -1))
+	while (digits.size() > 1 && (digits.back() == 0 || digits.back() == ~limb(0)))
 	{
 		digits.pop_back();
 		if (sign != signum())
@@ -523,17 +1294,122 @@ void big_integer::remove_redundancy()
 		}
 	}
 
-	if (digits.size() == 1)
+	// A single 64-bit limb may still be too wide for number.
+	if (digits.size() == 1 && static_cast<signed_limb>(digits.back()) == static_cast<std::int32_t>(digits.back()))
 	{
 		small = true;
-		number = digits.back();
-		digits = my_vector<std::uint32_t>();
+		number = static_cast<std::int32_t>(digits.back());
+		digits.clear();
+	}
+}
+
+void big_integer::set_int64(std::int64_t value)
+{
+	zero_setting();
+	for (int shift = 0; shift < 64; shift += limb_bits)
+	{
+		digits.push_back(static_cast<limb>(static_cast<std::uint64_t>(value) >> shift));
+	}
+	remove_redundancy();
+}
+
+void big_integer::set_words(std::uint64_t low, std::uint64_t high, bool negative)
+{
+	const size_t per_word = 64 / limb_bits;
+	limb a[2 * per_word + 1];
+	for (size_t i = 0; i < per_word; ++i)
+	{
+		a[i] = static_cast<limb>(low >> (i * limb_bits));
+		a[per_word + i] = static_cast<limb>(high >> (i * limb_bits));
 	}
+	a[2 * per_word] = negative ? ~limb(0) : 0;
+	set_limbs(a, 2 * per_word + 1);
+}
+
+bool big_integer::fits(int bits, bool is_signed) const
+{
+	// digits_count() is the shortest two's complement width.
+	if (is_signed) return digits_count() <= static_cast<size_t>(bits);
+	return !signum() && digits_count() <= static_cast<size_t>(bits) + 1;
+}
+
+void big_integer::low_limbs(limb* out, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (small)
+		{
+			out[i] = i == 0 ? static_cast<limb>(static_cast<signed_limb>(number)) : (number < 0 ? ~limb(0) : 0);
+		}
+		else
+		{
+			out[i] = at(i);
+		}
+	}
+}
+
+double big_integer::to_double() const
+{
+	if (small) return number;
+
+	// The top 64 bits of the magnitude, with the lowest one set if any bit below them is, round
+	// to nearest like the whole number does.
+	std::vector<limb> magnitude = this->magnitude();
+	size_t bits = magnitude.size() * limb_bits - limbs::leading_zeros(magnitude.back());
+	size_t shift = bits > 64 ? bits - 64 : 0;
+	std::uint64_t top = 0;
+	for (size_t i = bits; i-- > shift;)
+	{
+		top = top << 1 | ((magnitude[i / limb_bits] >> (i % limb_bits)) & 1);
+	}
+	bool sticky = false;
+	for (size_t i = 0; i < shift / limb_bits && !sticky; ++i)
+	{
+		sticky = magnitude[i] != 0;
+	}
+	if (shift % limb_bits != 0) sticky = sticky || (magnitude[shift / limb_bits] & ((limb(1) << (shift % limb_bits)) - 1)) != 0;
+
+	double result = std::ldexp(static_cast<double>(top | (sticky ? 1 : 0)), static_cast<int>(std::min<size_t>(shift, 2048)));
+	return signum() ? -result : result;
+}
+
+template <>
+bool big_integer::fits_in<double>() const
+{
+	return !std::isinf(to_double());
+}
+
+template <>
+double big_integer::to<double>() const
+{
+	double result = to_double();
+	if (std::isinf(result)) throw std::runtime_error("value does not fit");
+	return result;
+}
+
+void big_integer::set_limbs(limb const* a, size_t size)
+{
+	zero_setting();
+	digits.resize(size);
+	std::copy(a, a + size, digits.begin());
+	remove_redundancy();
+}
+
+void big_integer::set_magnitude(limb const* magnitude, size_t size, bool negative)
+{
+	// A zero top limb, where the magnitude needs one, keeps the value non-negative before negation. It is only
+	// added then, so that magnitudes that fit leave the limbs in the inline storage.
+	zero_setting();
+	size_t extension = size == 0 || (magnitude[size - 1] >> (limb_bits - 1)) != 0 ? 1 : 0;
+	digits.insert(digits.cend(), size + extension, 0);
+	std::copy(magnitude, magnitude + size, digits.begin());
+	if (negative) limbs::negate(digits.begin(), digits.cbegin(), digits.size());
+	remove_redundancy();
 }
 
 void big_integer::zero_setting()
 {
 	small = false;
 	number = 0;
-	digits = my_vector<std::uint32_t>();
+	digits.clear();
 }
\ No newline at end of file
@@ -1,17 +1,106 @@
 #pragma once
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <iosfwd>
+#include <limits>
 #include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 #include <cstdint>
-#include "my_vector.h"
+#include <type_traits>
+#include "limb_kernels.h"
+#include "small_vector.h"
+
+struct to_chars_result
+{
+	char* ptr;
+	std::errc ec;
+};
+
+struct from_chars_result
+{
+	char const* ptr;
+	std::errc ec;
+};
+
+// Width and signedness of the built-in integer types, __int128 included, which std::numeric_limits
+// only describes in GNU modes.
+template <typename T>
+struct integer_info
+{
+	static_assert(std::numeric_limits<T>::is_integer, "an integer type is needed");
+
+	static const int bits = std::numeric_limits<T>::digits + std::numeric_limits<T>::is_signed;
+	static const bool is_signed = std::numeric_limits<T>::is_signed;
+	typedef typename std::make_unsigned<T>::type unsigned_type;
+};
+
+#if defined(__SIZEOF_INT128__)
+template <>
+struct integer_info<__int128>
+{
+	static const int bits = 128;
+	static const bool is_signed = true;
+	typedef unsigned __int128 unsigned_type;
+};
+
+template <>
+struct integer_info<unsigned __int128>
+{
+	static const int bits = 128;
+	static const bool is_signed = false;
+	typedef unsigned __int128 unsigned_type;
+};
+#endif
 
 struct big_integer
 {
 	big_integer();
 	big_integer(big_integer const& other);
+	big_integer(big_integer&& other) noexcept;
 	big_integer(int a);
+	big_integer(long a);
+	big_integer(long long a);
+	big_integer(unsigned a);
+	big_integer(unsigned long a);
+	big_integer(unsigned long long a);
+#if defined(__SIZEOF_INT128__)
+	big_integer(__int128 a);
+	big_integer(unsigned __int128 a);
+#endif
+	// Truncates toward zero; throws for infinities and NaN.
+	explicit big_integer(double a);
 	explicit big_integer(std::string const& str);
 
 	big_integer& operator=(big_integer const& other) &;
+	big_integer& operator=(big_integer&& other) & noexcept;
+
+	// For the integer types above and double. Integers fit when in range; a double fits when the number
+	// rounds to a finite one.
+	template <typename T>
+	bool fits_in() const;
+	// Checked conversion: throws if the number does not fit in T. Doubles are rounded to nearest.
+	template <typename T>
+	T to() const;
+	// The low bits in two's complement, like a cast between integer types; integer types only.
+	template <typename T>
+	T truncate() const;
+
+	// Fused *this = a * b, *this += a * b and *this -= a * b. The product is formed in scratch space kept per
+	// thread and then lands in this number's own limbs, so loops over them stop allocating. Any of a, b and
+	// *this may be the same number.
+	big_integer& set_product(big_integer const& a, big_integer const& b) &;
+	big_integer& addmul(big_integer const& a, big_integer const& b) &;
+	big_integer& submul(big_integer const& a, big_integer const& b) &;
+	// *this += a * b and *this -= a * b for a single limb b, in one pass over the limbs of a.
+	big_integer& addmul_word(big_integer const& a, limbs::limb b) &;
+	big_integer& submul_word(big_integer const& a, limbs::limb b) &;
+
+	// Evaluates an expression from big_expression.h into this number.
+	template <typename E, typename = typename E::expression_tag>
+	big_integer& operator=(E const& e) &;
 
 	big_integer& operator+=(big_integer const& rhs) &;
 	big_integer& operator-=(big_integer const& rhs) &;
@@ -26,9 +115,13 @@ struct big_integer
 	big_integer& operator<<=(int rhs) &;
 	big_integer& operator>>=(int rhs) &;
 
-	big_integer operator+() const;
-	big_integer operator-() const;
-	big_integer operator~() const;
+	// The rvalue overloads reuse the storage of the operand.
+	big_integer operator+() const&;
+	big_integer operator+() &&;
+	big_integer operator-() const&;
+	big_integer operator-() &&;
+	big_integer operator~() const&;
+	big_integer operator~() &&;
 
 	big_integer& operator++() &;
 	big_integer operator++(int) &;
@@ -36,6 +129,12 @@ struct big_integer
 	big_integer& operator--() &;
 	big_integer operator--(int) &;
 
+	friend int compare(big_integer const& a, big_integer const& b);
+	friend size_t bit_length(big_integer const& a);
+	friend size_t popcount(big_integer const& a);
+	friend size_t countr_zero(big_integer const& a);
+	friend struct std::hash<big_integer>;
+
 	friend bool operator==(big_integer const& a, big_integer const& b);
 	friend bool operator!=(big_integer const& a, big_integer const& b);
 	friend bool operator<(big_integer const& a, big_integer const& b);
@@ -43,38 +142,98 @@ struct big_integer
 	friend bool operator<=(big_integer const& a, big_integer const& b);
 	friend bool operator>=(big_integer const& a, big_integer const& b);
 
+	friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+
+	friend big_integer gcd(big_integer const& a, big_integer const& b);
+	friend big_integer lcm(big_integer const& a, big_integer const& b);
+	friend big_integer isqrt(big_integer const& a);
+	friend big_integer pow(big_integer const& base, unsigned exponent);
+	friend big_integer mod_inverse(big_integer const& a, big_integer const& m);
 	friend std::string to_string(big_integer const& a);
+	friend to_chars_result to_chars(char* first, char* last, big_integer const& value, int base);
+	friend from_chars_result from_chars(char const* first, char const* last, big_integer& value, int base);
+	friend size_t serialized_size(big_integer const& value);
+	friend to_chars_result serialize(char* first, char* last, big_integer const& value);
+	friend from_chars_result deserialize(char const* first, char const* last, big_integer& value);
+	friend std::ostream& operator<<(std::ostream& s, big_integer const& a);
+	friend std::istream& operator>>(std::istream& s, big_integer& a);
+
+	friend struct montgomery_context;
+	friend struct big_divisor;
+	friend struct big_accumulator;
+	friend struct big_integer_array;
+	friend struct big_integer_view;
+	friend struct rns_integer;
+	template <size_t Bits> friend struct fixed_integer;
 
 private:
+	big_integer& add_signed(big_integer const& rhs, bool subtract);
+	// *this += b or *this -= b for two's complement limbs b that do not overlap this number's.
+	big_integer& add_limbs(limbs::limb const* b, size_t bn, bool subtract);
+	big_integer& add_product(big_integer const& a, big_integer const& b, bool subtract);
+	big_integer& add_word_product(big_integer const& a, limbs::limb b, bool subtract);
+	// |a * b| into the thread's scratch space, with a zero limb on top; returns whether a * b is negative.
+	static std::vector<limbs::limb> const& multiply_magnitudes(big_integer const& a, big_integer const& b, bool& negative);
 	bool signum() const;
-	std::uint32_t at(size_t index) const;
+	limbs::limb at(size_t index) const;
+	// Limbs of the absolute value without leading zeros, empty for zero.
+	std::vector<limbs::limb> magnitude() const;
+	void magnitude(std::vector<limbs::limb>& result) const;
 	size_t digits_count() const;
-	void set_bit(size_t which, bool value);
 	void remove_redundancy();
+	void set_int64(std::int64_t value);
+	// The 128-bit two's complement number [high low], extended with ones above if negative.
+	void set_words(std::uint64_t low, std::uint64_t high, bool negative);
+	bool fits(int bits, bool is_signed) const;
+	// The low n limbs in two's complement.
+	void low_limbs(limbs::limb* out, size_t n) const;
+	// Rounded to nearest; infinite when out of range.
+	double to_double() const;
+	// Two's complement limbs, the top bit of the last one giving the sign; size > 0.
+	void set_limbs(limbs::limb const* a, size_t size);
+	void set_magnitude(limbs::limb const* magnitude, size_t size, bool negative);
 	void to_big();
 	void zero_setting();
 
+	typedef void (*bitwise_kernel)(limbs::limb* r, limbs::limb const* a, limbs::limb const* b, size_t n);
+
 	template <typename F>
-	big_integer& bit_operation(F operation, big_integer const& rhs);
+	big_integer& bit_operation(F operation, bitwise_kernel kernel, big_integer const& rhs);
 
 	bool small;
 	std::int32_t number;
-	my_vector<std::uint32_t> digits;
+	// Two's complement limbs, up to 256 bits of them inline.
+	small_vector<limbs::limb, 256 / limbs::limb_bits> digits;
 };
 
+// The left operand is taken by value, so a temporary on the left is moved into the result.
+// For the commutative operators a temporary on the right is reused instead.
 big_integer operator+(big_integer a, big_integer const& b);
+big_integer operator+(big_integer const& a, big_integer&& b);
 big_integer operator-(big_integer a, big_integer const& b);
 big_integer operator*(big_integer a, big_integer const& b);
+big_integer operator*(big_integer const& a, big_integer&& b);
 big_integer operator/(big_integer a, big_integer const& b);
 big_integer operator%(big_integer a, big_integer const& b);
 
 big_integer operator&(big_integer a, big_integer const& b);
+big_integer operator&(big_integer const& a, big_integer&& b);
 big_integer operator|(big_integer a, big_integer const& b);
+big_integer operator|(big_integer const& a, big_integer&& b);
 big_integer operator^(big_integer a, big_integer const& b);
+big_integer operator^(big_integer const& a, big_integer&& b);
 
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
+// -1, 0 or 1 as a < b, a == b or a > b, in one pass from the top limbs down.
+int compare(big_integer const& a, big_integer const& b);
+
+// Bits of |a|, so 0 for 0; ones in |a|; the exponent of the largest power of two dividing a, 0 for 0.
+size_t bit_length(big_integer const& a);
+size_t popcount(big_integer const& a);
+size_t countr_zero(big_integer const& a);
+
 bool operator==(big_integer const& a, big_integer const& b);
 bool operator!=(big_integer const& a, big_integer const& b);
 
@@ -83,36 +242,123 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+
+// Both non-negative; gcd(0, 0) = 0 and lcm(a, 0) = 0.
+big_integer gcd(big_integer const& a, big_integer const& b);
+big_integer lcm(big_integer const& a, big_integer const& b);
+// floor(sqrt(a)) for a >= 0.
+big_integer isqrt(big_integer const& a);
+big_integer pow(big_integer const& base, unsigned exponent);
+// The x in [0, |m|) with a * x = 1 (mod m); throws if gcd(a, m) != 1.
+big_integer mod_inverse(big_integer const& a, big_integer const& m);
+
 std::string to_string(big_integer const& a);
+
+// Base 10 or a power of two up to 32, without prefixes. Behave like std::to_chars / std::from_chars.
+// to_chars allocates nothing for power-of-two bases and, in base 10, for numbers of up to 4096 bits. from_chars
+// allocates nothing for numbers that fit the inline storage: up to 76 decimal digits or 255 bits.
+to_chars_result to_chars(char* first, char* last, big_integer const& value, int base = 10);
+from_chars_result from_chars(char const* first, char const* last, big_integer& value, int base = 10);
+
+// Binary records: a little-endian 64-bit header holding 2 * words + 1 for negative numbers, then the magnitude
+// in that many little-endian 64-bit words without leading zero words. Records are a multiple of 8 bytes long.
+// serialize fails with std::errc::value_too_large and deserialize with std::errc::invalid_argument.
+size_t serialized_size(big_integer const& value);
+to_chars_result serialize(char* first, char* last, big_integer const& value);
+from_chars_result deserialize(char const* first, char const* last, big_integer& value);
+// Checks the record at first and returns its end, with the magnitude at first + 8.
+from_chars_result read_record_header(char const* first, char const* last, size_t& words, bool& negative);
+
+// Follow the stream's basefield: dec, hex or oct.
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+std::istream& operator>>(std::istream& s, big_integer& a);
+
+namespace std
+{
+	template <>
+	struct hash<big_integer>
+	{
+		size_t operator()(big_integer const& a) const;
+	};
+}
+
+
+template <typename T>
+bool big_integer::fits_in() const
+{
+	return fits(integer_info<T>::bits, integer_info<T>::is_signed);
+}
+
+template <>
+bool big_integer::fits_in<double>() const;
+
+template <typename T>
+T big_integer::to() const
+{
+	if (!fits_in<T>()) throw std::runtime_error("value does not fit");
+	return truncate<T>();
+}
 
+template <>
+double big_integer::to<double>() const;
+
+template <typename T>
+T big_integer::truncate() const
+{
+	typedef typename integer_info<T>::unsigned_type unsigned_type;
+	const size_t n = (integer_info<T>::bits + limbs::limb_bits - 1) / limbs::limb_bits;
+
+	limbs::limb low[n];
+	low_limbs(low, n);
+	unsigned_type result = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		result |= static_cast<unsigned_type>(low[i]) << (i * limbs::limb_bits);
+	}
+	return static_cast<T>(result);
+}
+
+template <typename E, typename>
+big_integer& big_integer::operator=(E const& e) &
+{
+	e.evaluate(*this);
+	return *this;
+}
 
 template <typename F>
-big_integer& big_integer::bit_operation(F operation, big_integer const& rhs)
+big_integer& big_integer::bit_operation(F operation, bitwise_kernel kernel, big_integer const& rhs)
 {
 	if (small && rhs.small)
 	{
 		number = operation(number, rhs.number);
 		return *this;
 	}
-	to_big();
+	if (this == &rhs) return bit_operation(operation, kernel, big_integer(rhs));
+
+	limbs::limb single = rhs.number;
+	limbs::limb const* b = rhs.small ? &single : rhs.digits.cbegin();
+	size_t bn = rhs.small ? 1 : rhs.digits.size();
 
-	big_integer b = rhs;
-	b.to_big();
+	to_big();
+	size_t an = digits.size();
+	limbs::limb a_extension = signum() ? ~limbs::limb(0) : 0;
+	limbs::limb b_extension = rhs.signum() ? ~limbs::limb(0) : 0;
 
-	for (int i = 0; i < digits.size() || i < b.digits.size(); ++i)
+	// Past the shorter operand the other one meets a constant extension limb, so the result there is
+	// a copy, a fill or a complement of the longer one.
+	digits.resize(std::max(an, bn));
+	kernel(digits.begin(), digits.cbegin(), b, std::min(an, bn));
+	if (an < bn)
+	{
+		limbs::bitwise_map(digits.begin() + an, b + an, bn - an, operation(a_extension, limbs::limb(0)), operation(a_extension, ~limbs::limb(0)));
+	}
+	else
 	{
-		if (i >= digits.size())
-		{
-			digits.push_back(operation(at(i), b.at(i)));
-		}
-		else
-		{
-			digits[i] = operation(digits[i], b.at(i));
-		}
+		limbs::bitwise_map(digits.begin() + bn, digits.cbegin() + bn, an - bn, operation(limbs::limb(0), b_extension), operation(~limbs::limb(0), b_extension));
 	}
 
 	remove_redundancy();
 
 	return *this;
-}
\ No newline at end of file
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <type_traits>
+#include "big_integer_array.h"
+
+using limbs::limb;
+using limbs::limb_bits;
+using limbs::double_limb;
+using limbs::signed_double_limb;
+
+typedef std::make_signed<limb>::type signed_limb;
+
+namespace
+{
+	limb sign_of(limb x)
+	{
+		return static_cast<limb>(static_cast<signed_limb>(x) >> (limb_bits - 1));
+	}
+}
+
+big_integer_array::big_integer_array()
+: count(0), capacity(0), columns(1)
+{
+}
+
+big_integer_array::big_integer_array(std::vector<big_integer> const& values)
+: big_integer_array()
+{
+	size_t width = 1;
+	for (auto const& a : values)
+	{
+		width = std::max(width, limbs_of(a));
+	}
+	reshape(width, values.size());
+	for (auto const& a : values)
+	{
+		push_back(a);
+	}
+}
+
+size_t big_integer_array::size() const
+{
+	return count;
+}
+
+size_t big_integer_array::width() const
+{
+	return columns;
+}
+
+void big_integer_array::push_back(big_integer const& a)
+{
+	if (count == capacity)
+	{
+		reshape(columns, std::max<size_t>(2 * capacity, 16));
+	}
+	++count;
+	set(count - 1, a);
+}
+
+big_integer big_integer_array::get(size_t index) const
+{
+	std::vector<limb> digits(columns);
+	for (size_t j = 0; j < columns; ++j)
+	{
+		digits[j] = column(j)[index];
+	}
+
+	big_integer result;
+	result.set_limbs(digits.data(), digits.size());
+	return result;
+}
+
+void big_integer_array::set(size_t index, big_integer const& a)
+{
+	widen(limbs_of(a));
+	for (size_t j = 0; j < columns; ++j)
+	{
+		column(j)[index] = limb_at(a, j);
+	}
+}
+
+std::vector<big_integer> big_integer_array::to_vector() const
+{
+	std::vector<big_integer> result;
+	result.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		result.push_back(get(i));
+	}
+	return result;
+}
+
+void big_integer_array::add(big_integer const& c)
+{
+	// One more column than either operand keeps the two's complement sum from wrapping around.
+	widen(std::max(columns, limbs_of(c)) + 1);
+
+	std::vector<limb> carries(count, 0);
+	limb* carry = carries.data();
+	for (size_t j = 0; j < columns; ++j)
+	{
+		limb* a = column(j);
+		limb b = limb_at(c, j);
+		for (size_t i = 0; i < count; ++i)
+		{
+			limb s = a[i] + b;
+			limb t = s + carry[i];
+			carry[i] = static_cast<limb>(s < b) + static_cast<limb>(t < s);
+			a[i] = t;
+		}
+	}
+
+	shrink();
+}
+
+void big_integer_array::mul(limb factor)
+{
+	// Modulo B^width, the product of the unsigned limbs is the two's complement product, and it fits
+	// with one more column.
+	widen(columns + 1);
+
+	std::vector<limb> carries(count, 0);
+	limb* carry = carries.data();
+	for (size_t j = 0; j < columns; ++j)
+	{
+		limb* a = column(j);
+		for (size_t i = 0; i < count; ++i)
+		{
+			double_limb p = static_cast<double_limb>(a[i]) * factor + carry[i];
+			a[i] = static_cast<limb>(p);
+			carry[i] = static_cast<limb>(p >> limb_bits);
+		}
+	}
+
+	shrink();
+}
+
+std::vector<int> big_integer_array::compare(big_integer const& c) const
+{
+	// From the top limb down, each value keeps the first difference; the top limb compares signed.
+	std::vector<int> result(count, 0);
+	int* r = result.data();
+	size_t width = std::max(columns, limbs_of(c));
+	for (size_t j = width; j-- > 0;)
+	{
+		limb const* a = column(std::min(j, columns - 1));
+		limb b = limb_at(c, j);
+		bool extension = j >= columns;
+		bool top = j + 1 == width;
+		for (size_t i = 0; i < count; ++i)
+		{
+			limb x = extension ? sign_of(a[i]) : a[i];
+			int difference = top ? (static_cast<signed_limb>(x) > static_cast<signed_limb>(b)) - (static_cast<signed_limb>(x) < static_cast<signed_limb>(b)) : (x > b) - (x < b);
+			r[i] = r[i] != 0 ? r[i] : difference;
+		}
+	}
+	return result;
+}
+
+big_integer big_integer_array::sum() const
+{
+	// Column sums fit in two limbs; the top column is summed as signed limbs.
+	size_t n = columns + 3;
+	std::vector<limb> result(n, 0);
+	for (size_t j = 0; j + 1 < columns; ++j)
+	{
+		limb const* a = column(j);
+		double_limb s = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			s += a[i];
+		}
+		limb parts[2] = {static_cast<limb>(s), static_cast<limb>(s >> limb_bits)};
+		limbs::add(result.data() + j, result.data() + j, n - j, parts, 2);
+	}
+
+	limb const* top = column(columns - 1);
+	signed_double_limb s = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		s += static_cast<signed_limb>(top[i]);
+	}
+	limb parts[2] = {static_cast<limb>(s), static_cast<limb>(s >> limb_bits)};
+	limbs::add_signed(result.data() + columns - 1, result.data() + columns - 1, n - columns + 1, parts, 2);
+
+	big_integer a;
+	a.set_limbs(result.data(), n);
+	return a;
+}
+
+size_t big_integer_array::limbs_of(big_integer const& a)
+{
+	return a.small ? 1 : a.digits.size();
+}
+
+limb big_integer_array::limb_at(big_integer const& a, size_t j)
+{
+	if (a.small) return j == 0 ? static_cast<limb>(static_cast<signed_limb>(a.number)) : sign_of(static_cast<limb>(static_cast<signed_limb>(a.number)));
+	return j < a.digits.size() ? a.digits[j] : sign_of(a.digits.back());
+}
+
+limb* big_integer_array::column(size_t j)
+{
+	return data.data() + j * capacity;
+}
+
+limb const* big_integer_array::column(size_t j) const
+{
+	return data.data() + j * capacity;
+}
+
+void big_integer_array::reshape(size_t new_columns, size_t new_capacity)
+{
+	// Room for half as many columns again, so that widen() only reallocates once the values have grown that much.
+	std::vector<limb> reshaped((new_columns + new_columns / 2 + 1) * new_capacity);
+	for (size_t j = 0; j < new_columns; ++j)
+	{
+		limb const* from = column(std::min(j, columns - 1));
+		limb* to = reshaped.data() + j * new_capacity;
+		if (j < columns)
+		{
+			std::copy(from, from + count, to);
+		}
+		else
+		{
+			std::transform(from, from + count, to, sign_of);
+		}
+	}
+
+	data.swap(reshaped);
+	columns = new_columns;
+	capacity = new_capacity;
+}
+
+void big_integer_array::widen(size_t new_columns)
+{
+	if (new_columns <= columns) return;
+	if (new_columns * capacity > data.size())
+	{
+		reshape(new_columns, capacity);
+		return;
+	}
+
+	limb const* top = column(columns - 1);
+	for (size_t j = columns; j < new_columns; ++j)
+	{
+		std::transform(top, top + count, column(j), sign_of);
+	}
+	columns = new_columns;
+}
+
+void big_integer_array::shrink()
+{
+	while (columns > 1)
+	{
+		limb const* top = column(columns - 1);
+		limb const* below = column(columns - 2);
+		bool redundant = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			redundant &= top[i] == sign_of(below[i]);
+		}
+		if (!redundant) break;
+		--columns;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// Many numbers stored column by column: limb j of every value is contiguous, and all values are sign extended
+// to the same number of two's complement limbs. The batched operations run over one column at a time with
+// per-value carries, so the compiler can vectorize them across values.
+struct big_integer_array
+{
+	big_integer_array();
+	explicit big_integer_array(std::vector<big_integer> const& values);
+
+	size_t size() const;
+	// Limbs per value.
+	size_t width() const;
+
+	void push_back(big_integer const& a);
+	big_integer get(size_t index) const;
+	void set(size_t index, big_integer const& a);
+	std::vector<big_integer> to_vector() const;
+
+	// a[i] += c and a[i] *= factor for every i.
+	void add(big_integer const& c);
+	void mul(limbs::limb factor);
+	// The sign of a[i] - c for every i.
+	std::vector<int> compare(big_integer const& c) const;
+	// The sum of all values.
+	big_integer sum() const;
+
+private:
+	static size_t limbs_of(big_integer const& a);
+	// Limb j of a, sign extended past its top.
+	static limbs::limb limb_at(big_integer const& a, size_t j);
+
+	limbs::limb* column(size_t j);
+	limbs::limb const* column(size_t j) const;
+	// Moves the values to a buffer of the given shape, sign extending them to the new width. The buffer keeps
+	// spare columns beyond it.
+	void reshape(size_t new_columns, size_t new_capacity);
+	// Sign extends the values to at least new_columns, in the spare columns while there are enough of them.
+	void widen(size_t new_columns);
+	// Drops top columns that only repeat the sign of every value; their storage stays as spare columns.
+	void shrink();
+
+	size_t count;
+	size_t capacity;
+	size_t columns;
+	// Limb j of value i at j * capacity + i.
+	std::vector<limbs::limb> data;
+};
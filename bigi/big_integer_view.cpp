@@ -0,0 +1,52 @@
+#include <cstdint>
+#include "big_integer_view.h"
+
+using limbs::limb;
+
+big_integer_view::big_integer_view()
+: magnitude(nullptr), count(0), sign(false)
+{
+}
+
+bool big_integer_view::negative() const
+{
+	return sign;
+}
+
+limb const* big_integer_view::data() const
+{
+	return magnitude;
+}
+
+size_t big_integer_view::size() const
+{
+	return count;
+}
+
+big_integer big_integer_view::value() const
+{
+	big_integer result;
+	result.set_magnitude(magnitude, count, sign);
+	return result;
+}
+
+from_chars_result deserialize(char const* first, char const* last, big_integer_view& view)
+{
+	if (reinterpret_cast<std::uintptr_t>(first) % 8 != 0) return { first, std::errc::invalid_argument };
+
+	size_t words;
+	bool negative;
+	from_chars_result result = read_record_header(first, last, words, negative);
+	if (result.ec != std::errc()) return result;
+
+	view.magnitude = reinterpret_cast<limb const*>(first + 8);
+	view.count = limbs::normalized_size(view.magnitude, words * (64 / limbs::limb_bits));
+	view.sign = negative;
+	return result;
+}
+
+std::string to_string(big_integer_view const& a)
+{
+	if (a.size() == 0) return "0";
+	return (a.negative() ? "-" : "") + limbs::to_decimal(a.data(), a.size());
+}
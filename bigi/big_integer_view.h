@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "big_integer_view reads the limbs of records in place, which needs a little-endian target"
+#endif
+
+// A binary record (see serialize) read in place, for example from a memory-mapped file of records.
+// The limbs are not copied, so the buffer has to outlive the view, and records must start 8-byte aligned.
+struct big_integer_view
+{
+	big_integer_view();
+
+	bool negative() const;
+	// The magnitude, without leading zero limbs.
+	limbs::limb const* data() const;
+	size_t size() const;
+
+	big_integer value() const;
+
+	friend from_chars_result deserialize(char const* first, char const* last, big_integer_view& view);
+
+private:
+	limbs::limb const* magnitude;
+	size_t count;
+	bool sign;
+};
+
+// Points view at the record at first and returns its end. Fails like deserialize into a big_integer,
+// and with std::errc::invalid_argument for a misaligned record.
+from_chars_result deserialize(char const* first, char const* last, big_integer_view& view);
+
+std::string to_string(big_integer_view const& a);
@@ -0,0 +1,328 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// A two's complement integer of Bits bits that lives on the stack, with the operators of big_integer.
+// Results wrap around modulo 2^Bits; division truncates like big_integer's. Every loop runs over a
+// compile-time number of 32-bit words, so the compiler unrolls them, and all of it works in constant
+// expressions. Conversions from big_integer keep the low Bits bits, which is lossless whenever the value fits.
+template <size_t Bits>
+struct fixed_integer
+{
+	static_assert(Bits % 32 == 0 && Bits >= 64, "fixed_integer needs a multiple of 32 bits, at least 64");
+
+	typedef std::uint32_t word;
+	enum : size_t { word_count = Bits / 32 };
+
+	constexpr fixed_integer()
+	: words{}
+	{
+	}
+
+	constexpr fixed_integer(long long a)
+	: words{}
+	{
+		word extension = a < 0 ? ~word(0) : 0;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			words[i] = i < 2 ? static_cast<word>(static_cast<unsigned long long>(a) >> (32 * i)) : extension;
+		}
+	}
+
+	explicit fixed_integer(big_integer const& a)
+	: words{}
+	{
+		limbs::limb extension = a.signum() ? ~limbs::limb(0) : 0;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			size_t index = i * 32 / limbs::limb_bits;
+			limbs::limb x = a.small ? (index == 0 ? static_cast<limbs::limb>(static_cast<long long>(a.number)) : extension)
+				: index < a.digits.size() ? a.digits[index] : extension;
+			words[i] = static_cast<word>(x >> (i * 32 % limbs::limb_bits));
+		}
+	}
+
+	explicit operator big_integer() const
+	{
+		const size_t per_limb = limbs::limb_bits / 32;
+		limbs::limb digits[(word_count + per_limb - 1) / per_limb] = {};
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			digits[i / per_limb] |= static_cast<limbs::limb>(words[i]) << (i % per_limb * 32);
+		}
+		// An odd number of words in 64-bit limbs leaves the top half of the last limb to sign extend.
+		if (word_count % per_limb != 0 && negative())
+		{
+			digits[word_count / per_limb] |= ~limbs::limb(0) << (word_count % per_limb * 32);
+		}
+
+		big_integer result;
+		result.set_limbs(digits, sizeof(digits) / sizeof(digits[0]));
+		return result;
+	}
+
+	constexpr bool negative() const
+	{
+		return (words[word_count - 1] >> 31) != 0;
+	}
+
+	constexpr fixed_integer& operator+=(fixed_integer const& rhs)
+	{
+		std::uint64_t carry = 0;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			carry += static_cast<std::uint64_t>(words[i]) + rhs.words[i];
+			words[i] = static_cast<word>(carry);
+			carry >>= 32;
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator-=(fixed_integer const& rhs)
+	{
+		std::uint64_t borrow = 0;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			std::uint64_t difference = static_cast<std::uint64_t>(words[i]) - rhs.words[i] - borrow;
+			words[i] = static_cast<word>(difference);
+			borrow = (difference >> 32) & 1;
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator*=(fixed_integer const& rhs)
+	{
+		// Only the products that land below 2^Bits.
+		word product[word_count] = {};
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			std::uint64_t carry = 0;
+			for (size_t j = 0; i + j < word_count; ++j)
+			{
+				carry += static_cast<std::uint64_t>(words[i]) * rhs.words[j] + product[i + j];
+				product[i + j] = static_cast<word>(carry);
+				carry >>= 32;
+			}
+		}
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			words[i] = product[i];
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator/=(fixed_integer const& rhs)
+	{
+		fixed_integer remainder;
+		divide(rhs, *this, remainder);
+		return *this;
+	}
+
+	constexpr fixed_integer& operator%=(fixed_integer const& rhs)
+	{
+		fixed_integer quotient;
+		divide(rhs, quotient, *this);
+		return *this;
+	}
+
+	constexpr fixed_integer& operator&=(fixed_integer const& rhs)
+	{
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			words[i] &= rhs.words[i];
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator|=(fixed_integer const& rhs)
+	{
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			words[i] |= rhs.words[i];
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator^=(fixed_integer const& rhs)
+	{
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			words[i] ^= rhs.words[i];
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator<<=(int rhs)
+	{
+		size_t word_shift = static_cast<size_t>(rhs) / 32;
+		int bit_shift = rhs % 32;
+		for (size_t i = word_count; i-- > 0;)
+		{
+			word high = i >= word_shift ? words[i - word_shift] : 0;
+			word low = i > word_shift ? words[i - word_shift - 1] : 0;
+			words[i] = bit_shift == 0 ? high : (high << bit_shift) | (low >> (32 - bit_shift));
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer& operator>>=(int rhs)
+	{
+		word extension = negative() ? ~word(0) : 0;
+		size_t word_shift = static_cast<size_t>(rhs) / 32;
+		int bit_shift = rhs % 32;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			word low = i + word_shift < word_count ? words[i + word_shift] : extension;
+			word high = i + word_shift + 1 < word_count ? words[i + word_shift + 1] : extension;
+			words[i] = bit_shift == 0 ? low : (low >> bit_shift) | (high << (32 - bit_shift));
+		}
+		return *this;
+	}
+
+	constexpr fixed_integer operator+() const
+	{
+		return *this;
+	}
+
+	constexpr fixed_integer operator-() const
+	{
+		return fixed_integer() -= *this;
+	}
+
+	constexpr fixed_integer operator~() const
+	{
+		fixed_integer result;
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			result.words[i] = ~words[i];
+		}
+		return result;
+	}
+
+	constexpr fixed_integer& operator++()
+	{
+		return *this += 1;
+	}
+
+	constexpr fixed_integer operator++(int)
+	{
+		fixed_integer result = *this;
+		++*this;
+		return result;
+	}
+
+	constexpr fixed_integer& operator--()
+	{
+		return *this -= 1;
+	}
+
+	constexpr fixed_integer operator--(int)
+	{
+		fixed_integer result = *this;
+		--*this;
+		return result;
+	}
+
+	// Friends defined here, so that mixed operands like a + 1 convert.
+	friend constexpr fixed_integer operator+(fixed_integer a, fixed_integer const& b) { return a += b; }
+	friend constexpr fixed_integer operator-(fixed_integer a, fixed_integer const& b) { return a -= b; }
+	friend constexpr fixed_integer operator*(fixed_integer a, fixed_integer const& b) { return a *= b; }
+	friend constexpr fixed_integer operator/(fixed_integer a, fixed_integer const& b) { return a /= b; }
+	friend constexpr fixed_integer operator%(fixed_integer a, fixed_integer const& b) { return a %= b; }
+
+	friend constexpr fixed_integer operator&(fixed_integer a, fixed_integer const& b) { return a &= b; }
+	friend constexpr fixed_integer operator|(fixed_integer a, fixed_integer const& b) { return a |= b; }
+	friend constexpr fixed_integer operator^(fixed_integer a, fixed_integer const& b) { return a ^= b; }
+
+	friend constexpr fixed_integer operator<<(fixed_integer a, int b) { return a <<= b; }
+	friend constexpr fixed_integer operator>>(fixed_integer a, int b) { return a >>= b; }
+
+	friend constexpr bool operator==(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) == 0; }
+	friend constexpr bool operator!=(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) != 0; }
+	friend constexpr bool operator<(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) < 0; }
+	friend constexpr bool operator>(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) > 0; }
+	friend constexpr bool operator<=(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) <= 0; }
+	friend constexpr bool operator>=(fixed_integer const& a, fixed_integer const& b) { return compare(a, b) >= 0; }
+
+	friend std::string to_string(fixed_integer const& a)
+	{
+		return to_string(big_integer(a));
+	}
+
+	// Little-endian.
+	word words[word_count];
+
+private:
+	static constexpr int compare(fixed_integer const& a, fixed_integer const& b)
+	{
+		if (a.negative() != b.negative()) return a.negative() ? -1 : 1;
+		for (size_t i = word_count; i-- > 0;)
+		{
+			if (a.words[i] != b.words[i]) return a.words[i] < b.words[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	// Unsigned compare of the words.
+	static constexpr bool below(fixed_integer const& a, fixed_integer const& b)
+	{
+		for (size_t i = word_count; i-- > 0;)
+		{
+			if (a.words[i] != b.words[i]) return a.words[i] < b.words[i];
+		}
+		return false;
+	}
+
+	// Truncating division of *this by divisor on the magnitudes; the remainder takes the sign of *this.
+	constexpr void divide(fixed_integer const& divisor, fixed_integer& quotient, fixed_integer& remainder) const
+	{
+		if (divisor == 0) throw std::runtime_error("division by zero");
+
+		bool negative_quotient = negative() != divisor.negative();
+		bool negative_remainder = negative();
+		// The magnitude of the smallest value is itself, read as unsigned.
+		fixed_integer a = negative() ? -*this : *this;
+		fixed_integer b = divisor.negative() ? -divisor : divisor;
+
+		quotient = fixed_integer();
+		remainder = fixed_integer();
+		size_t b_words = word_count;
+		while (b.words[b_words - 1] == 0)
+		{
+			--b_words;
+		}
+
+		if (b_words == 1)
+		{
+			std::uint64_t rest = 0;
+			for (size_t i = word_count; i-- > 0;)
+			{
+				rest = rest << 32 | a.words[i];
+				quotient.words[i] = static_cast<word>(rest / b.words[0]);
+				rest %= b.words[0];
+			}
+			remainder.words[0] = static_cast<word>(rest);
+		}
+		else
+		{
+			// Shift and subtract, from the top bit of a down.
+			for (size_t i = Bits; i-- > 0;)
+			{
+				remainder <<= 1;
+				remainder.words[0] |= (a.words[i / 32] >> (i % 32)) & 1;
+				if (!below(remainder, b))
+				{
+					remainder -= b;
+					quotient.words[i / 32] |= word(1) << (i % 32);
+				}
+			}
+		}
+
+		if (negative_quotient) quotient = -quotient;
+		if (negative_remainder) remainder = -remainder;
+	}
+};
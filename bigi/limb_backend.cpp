@@ -0,0 +1,144 @@
+#include <memory>
+#include <stdexcept>
+#include "limb_backend.h"
+#include "../dylib/dynamic_library.h"
+
+namespace limbs
+{
+	namespace
+	{
+		kernel_table const* active = &kernel::table;
+		// The backend in use. It is only closed when another one replaces it, never at exit, where static
+		// destructors may still be doing arithmetic.
+		dynamic_library* library = nullptr;
+
+		bool supported(std::string const& backend)
+		{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			if (backend == "adx")
+			{
+				return __builtin_cpu_supports("adx") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("avx2");
+			}
+			if (backend == "avx2") return __builtin_cpu_supports("avx2");
+#endif
+			return backend == "scalar";
+		}
+	}
+
+	kernel_table const& kernels()
+	{
+		return *active;
+	}
+
+	void set_kernels(kernel_table const& table)
+	{
+		if (table.limb_bits != limb_bits) throw std::runtime_error("kernels of another limb width");
+		active = &table;
+	}
+
+	std::string load_kernels(std::string const& directory)
+	{
+		for (std::string backend : {"adx", "avx2", "scalar"})
+		{
+			if (!supported(backend)) continue;
+
+			std::string path = directory + "/bigi_kernels_" + backend + "_" + std::to_string(limb_bits) + ".so";
+			try
+			{
+				std::unique_ptr<dynamic_library> loaded(new dynamic_library(path));
+				kernel_table const* table = loaded->load_function<kernel_table const* (*)()>("bigi_kernels")();
+				if (table->limb_bits != limb_bits) continue;
+
+				active = table;
+				delete library;
+				library = loaded.release();
+				return active->name;
+			}
+			catch (std::domain_error const&)
+			{
+			}
+		}
+		return active->name;
+	}
+
+	limb add(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		return active->add(r, a, an, b, bn);
+	}
+
+	limb sub(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		return active->sub(r, a, an, b, bn);
+	}
+
+	void add_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		active->add_signed(r, a, an, b, bn);
+	}
+
+	void sub_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		active->sub_signed(r, a, an, b, bn);
+	}
+
+	void negate(limb* r, limb const* a, size_t n)
+	{
+		active->negate(r, a, n);
+	}
+
+	limb mul_1(limb* r, limb const* a, size_t n, limb b)
+	{
+		return active->mul_1(r, a, n, b);
+	}
+
+	limb addmul_1(limb* r, limb const* a, size_t n, limb b)
+	{
+		return active->addmul_1(r, a, n, b);
+	}
+
+	limb submul_1(limb* r, limb const* a, size_t n, limb b)
+	{
+		return active->submul_1(r, a, n, b);
+	}
+
+	void mul_basecase(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		active->mul_basecase(r, a, an, b, bn);
+	}
+
+	void sqr_basecase(limb* r, limb const* a, size_t n)
+	{
+		active->sqr_basecase(r, a, n);
+	}
+
+	limb lshift(limb* r, limb const* a, size_t n, int shift)
+	{
+		return active->lshift(r, a, n, shift);
+	}
+
+	limb rshift(limb* r, limb const* a, size_t n, int shift)
+	{
+		return active->rshift(r, a, n, shift);
+	}
+
+	void and_n(limb* r, limb const* a, limb const* b, size_t n)
+	{
+		active->and_n(r, a, b, n);
+	}
+
+	void or_n(limb* r, limb const* a, limb const* b, size_t n)
+	{
+		active->or_n(r, a, b, n);
+	}
+
+	void xor_n(limb* r, limb const* a, limb const* b, size_t n)
+	{
+		active->xor_n(r, a, b, n);
+	}
+
+	void bitwise_map(limb* r, limb const* a, size_t n, limb zeros, limb ones)
+	{
+		active->bitwise_map(r, a, n, zeros, ones);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "limb_kernels.h"
+
+// The loops at the bottom of every operation (carry chains, single-limb and basecase products, shifts and
+// bitwise operations) go through a table of function pointers. It starts out with the ones built into the library,
+// compiled with the library's own flags, and load_kernels() can replace them at startup with a backend shared object
+// compiled for newer instruction sets, so that one binary runs the fastest kernels each host supports.
+namespace limbs
+{
+	// Signatures and contracts as in limb_kernels.h.
+	struct kernel_table
+	{
+		char const* name;
+		// BIGI_LIMB_BITS the kernels were compiled for.
+		int limb_bits;
+
+		limb (*add)(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		limb (*sub)(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void (*add_signed)(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void (*sub_signed)(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void (*negate)(limb* r, limb const* a, size_t n);
+
+		limb (*mul_1)(limb* r, limb const* a, size_t n, limb b);
+		limb (*addmul_1)(limb* r, limb const* a, size_t n, limb b);
+		limb (*submul_1)(limb* r, limb const* a, size_t n, limb b);
+		void (*mul_basecase)(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void (*sqr_basecase)(limb* r, limb const* a, size_t n);
+
+		limb (*lshift)(limb* r, limb const* a, size_t n, int shift);
+		limb (*rshift)(limb* r, limb const* a, size_t n, int shift);
+
+		void (*and_n)(limb* r, limb const* a, limb const* b, size_t n);
+		void (*or_n)(limb* r, limb const* a, limb const* b, size_t n);
+		void (*xor_n)(limb* r, limb const* a, limb const* b, size_t n);
+		void (*bitwise_map)(limb* r, limb const* a, size_t n, limb zeros, limb ones);
+	};
+
+	kernel_table const& kernels();
+	// Neither of these may be called while operations are running.
+	void set_kernels(kernel_table const& table);
+	// Loads the first backend among bigi_kernels_{adx,avx2,scalar}_<limb_bits>.so in directory that the CPU
+	// supports (ADX and BMI2, AVX2, anything) and switches to its kernels, keeping the built-in ones if none of
+	// them loads. Returns the name of the kernels in use.
+	std::string load_kernels(std::string const& directory);
+
+	// The kernels themselves, built into the library and, with BIGI_KERNEL_BACKEND defined as the backend's name,
+	// into the backend shared objects (see the makefile).
+	namespace kernel
+	{
+		extern kernel_table const table;
+
+		limb add(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		limb sub(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void add_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void sub_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void negate(limb* r, limb const* a, size_t n);
+
+		limb mul_1(limb* r, limb const* a, size_t n, limb b);
+		limb addmul_1(limb* r, limb const* a, size_t n, limb b);
+		limb submul_1(limb* r, limb const* a, size_t n, limb b);
+		void mul_basecase(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+		void sqr_basecase(limb* r, limb const* a, size_t n);
+
+		limb lshift(limb* r, limb const* a, size_t n, int shift);
+		limb rshift(limb* r, limb const* a, size_t n, int shift);
+
+		void and_n(limb* r, limb const* a, limb const* b, size_t n);
+		void or_n(limb* r, limb const* a, limb const* b, size_t n);
+		void xor_n(limb* r, limb const* a, limb const* b, size_t n);
+		void bitwise_map(limb* r, limb const* a, size_t n, limb zeros, limb ones);
+	}
+}
+
+// What a backend shared object exports; the table lives as long as the object stays loaded.
+extern "C" limbs::kernel_table const* bigi_kernels();
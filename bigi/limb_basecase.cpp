@@ -0,0 +1,227 @@
+#include <algorithm>
+#include "limb_backend.h"
+
+#if BIGI_LIMB_BITS == 64 && (defined(__x86_64__) || defined(_M_X64))
+#include <immintrin.h>
+#define BIGI_ADDCARRY_64
+#elif BIGI_LIMB_BITS == 32 && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define BIGI_ADDCARRY_32
+#endif
+
+namespace limbs
+{
+	namespace
+	{
+		// *r = a + b + carry; returns the carry out.
+		inline unsigned char add_carry(unsigned char carry, limb a, limb b, limb* r)
+		{
+#if defined(BIGI_ADDCARRY_64)
+			unsigned long long sum;
+			carry = _addcarry_u64(carry, a, b, &sum);
+			*r = sum;
+			return carry;
+#elif defined(BIGI_ADDCARRY_32)
+			return _addcarry_u32(carry, a, b, r);
+#else
+			double_limb s = static_cast<double_limb>(a) + b + carry;
+			*r = static_cast<limb>(s);
+			return static_cast<unsigned char>(s >> limb_bits);
+#endif
+		}
+
+		// *r = a - b - borrow; returns the borrow out.
+		inline unsigned char sub_borrow(unsigned char borrow, limb a, limb b, limb* r)
+		{
+#if defined(BIGI_ADDCARRY_64)
+			unsigned long long difference;
+			borrow = _subborrow_u64(borrow, a, b, &difference);
+			*r = difference;
+			return borrow;
+#elif defined(BIGI_ADDCARRY_32)
+			return _subborrow_u32(borrow, a, b, r);
+#else
+			double_limb d = static_cast<double_limb>(a) - b - borrow;
+			*r = static_cast<limb>(d);
+			return static_cast<unsigned char>((d >> limb_bits) & 1);
+#endif
+		}
+	}
+
+	namespace kernel
+	{
+		limb add(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			unsigned char carry = 0;
+			size_t i = 0;
+			for (; i < bn; ++i)
+			{
+				carry = add_carry(carry, a[i], b[i], &r[i]);
+			}
+			for (; i < an; ++i)
+			{
+				if (carry == 0 && r == a) return 0;
+				carry = add_carry(carry, a[i], 0, &r[i]);
+			}
+			return carry;
+		}
+
+		limb sub(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			unsigned char borrow = 0;
+			size_t i = 0;
+			for (; i < bn; ++i)
+			{
+				borrow = sub_borrow(borrow, a[i], b[i], &r[i]);
+			}
+			for (; i < an; ++i)
+			{
+				if (borrow == 0 && r == a) return 0;
+				borrow = sub_borrow(borrow, a[i], 0, &r[i]);
+			}
+			return borrow;
+		}
+
+		void add_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			unsigned char carry = 0;
+			for (size_t i = 0; i < bn; ++i)
+			{
+				carry = add_carry(carry, a[i], b[i], &r[i]);
+			}
+
+			// Adding the all-ones extension with a carry in leaves a limb unchanged and carries out again.
+			limb extension = bn != 0 && (b[bn - 1] >> (limb_bits - 1)) != 0 ? ~limb(0) : 0;
+			unsigned char stable = extension != 0;
+			for (size_t i = bn; i < an; ++i)
+			{
+				if (carry == stable && r == a) return;
+				carry = add_carry(carry, a[i], extension, &r[i]);
+			}
+		}
+
+		void sub_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			unsigned char borrow = 0;
+			for (size_t i = 0; i < bn; ++i)
+			{
+				borrow = sub_borrow(borrow, a[i], b[i], &r[i]);
+			}
+
+			limb extension = bn != 0 && (b[bn - 1] >> (limb_bits - 1)) != 0 ? ~limb(0) : 0;
+			unsigned char stable = extension != 0;
+			for (size_t i = bn; i < an; ++i)
+			{
+				if (borrow == stable && r == a) return;
+				borrow = sub_borrow(borrow, a[i], extension, &r[i]);
+			}
+		}
+
+		void negate(limb* r, limb const* a, size_t n)
+		{
+			// -a = ~a + 1: the low zero limbs stay zero, the first non-zero one is negated and the rest inverted.
+			size_t i = 0;
+			for (; i < n && a[i] == 0; ++i)
+			{
+				r[i] = 0;
+			}
+			if (i == n) return;
+			r[i] = 0 - a[i];
+			for (++i; i < n; ++i)
+			{
+				r[i] = ~a[i];
+			}
+		}
+
+		limb mul_1(limb* r, limb const* a, size_t n, limb b)
+		{
+			double_limb carry = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				carry += static_cast<double_limb>(a[i]) * b;
+				r[i] = static_cast<limb>(carry);
+				carry >>= limb_bits;
+			}
+			return static_cast<limb>(carry);
+		}
+
+		limb addmul_1(limb* r, limb const* a, size_t n, limb b)
+		{
+			double_limb carry = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				carry += static_cast<double_limb>(a[i]) * b + r[i];
+				r[i] = static_cast<limb>(carry);
+				carry >>= limb_bits;
+			}
+			return static_cast<limb>(carry);
+		}
+
+		limb submul_1(limb* r, limb const* a, size_t n, limb b)
+		{
+			double_limb carry = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				carry += static_cast<double_limb>(a[i]) * b;
+				limb low = static_cast<limb>(carry);
+				carry >>= limb_bits;
+				if (r[i] < low) ++carry;
+				r[i] -= low;
+			}
+			return static_cast<limb>(carry);
+		}
+
+		void mul_basecase(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			r[bn] = mul_1(r, b, bn, a[0]);
+			for (size_t i = 1; i < an; ++i)
+			{
+				r[i + bn] = addmul_1(r + i, b, bn, a[i]);
+			}
+		}
+
+		void sqr_basecase(limb* r, limb const* a, size_t n)
+		{
+			// Each product a[i] * a[j] with i < j once, doubled, then the squares a[i] * a[i].
+			std::fill(r, r + 2 * n, 0);
+			for (size_t i = 0; i < n; ++i)
+			{
+				r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+			}
+			lshift(r, r, 2 * n, 1);
+
+			limb carry = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				double_limb square = static_cast<double_limb>(a[i]) * a[i];
+				double_limb sum = static_cast<double_limb>(r[2 * i]) + static_cast<limb>(square) + carry;
+				r[2 * i] = static_cast<limb>(sum);
+				sum = static_cast<double_limb>(r[2 * i + 1]) + static_cast<limb>(square >> limb_bits) + static_cast<limb>(sum >> limb_bits);
+				r[2 * i + 1] = static_cast<limb>(sum);
+				carry = static_cast<limb>(sum >> limb_bits);
+			}
+		}
+
+		kernel_table const table = {
+#if defined(BIGI_KERNEL_BACKEND)
+			BIGI_KERNEL_BACKEND,
+#else
+			"built-in",
+#endif
+			limb_bits,
+			add, sub, add_signed, sub_signed, negate,
+			mul_1, addmul_1, submul_1,
+			mul_basecase, sqr_basecase,
+			lshift, rshift,
+			and_n, or_n, xor_n, bitwise_map};
+	}
+}
+
+#if defined(BIGI_KERNEL_BACKEND)
+// Backends are built with -fvisibility=hidden, so that this is all they export and their kernels never bind to
+// the ones in the library.
+extern "C" __attribute__((visibility("default"))) limbs::kernel_table const* bigi_kernels()
+{
+	return &limbs::kernel::table;
+}
+#endif
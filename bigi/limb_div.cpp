@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <vector>
+#include "limb_kernels.h"
+
+namespace limbs
+{
+	size_t burnikel_ziegler_threshold = 50;
+
+	namespace
+	{
+		void decrement(limb* a, size_t n)
+		{
+			for (size_t i = 0; i < n && a[i]-- == 0; ++i)
+			{
+			}
+		}
+
+		void div_3n_2n(limb* q, limb* r, limb const* a, limb const* b, size_t h);
+
+		// q (n limbs) = a / b, r (n limbs) = a % b, where a has 2n limbs, a < b * B^n and b is normalized.
+		void div_2n_1n(limb* q, limb* r, limb const* a, limb const* b, size_t n)
+		{
+			if (n % 2 != 0 || n < burnikel_ziegler_threshold)
+			{
+				std::vector<limb> quotient(n + 1);
+				if (n == 1)
+				{
+					r[0] = divrem_1(quotient.data(), a, 2, b[0]);
+				}
+				else
+				{
+					divrem_knuth(quotient.data(), r, a, 2 * n, b, n);
+				}
+				std::copy(quotient.begin(), quotient.begin() + n, q);
+				return;
+			}
+
+			size_t h = n / 2;
+			std::vector<limb> t(3 * h);
+			div_3n_2n(q + h, t.data() + h, a + h, b, h);
+			std::copy(a, a + h, t.begin());
+			div_3n_2n(q, r, t.data(), b, h);
+		}
+
+		// q (h limbs) = a / b, r (2h limbs) = a % b, where a has 3h limbs, b has 2h limbs,
+		// a < b * B^h and b is normalized.
+		void div_3n_2n(limb* q, limb* r, limb const* a, limb const* b, size_t h)
+		{
+			limb const* b_low = b;
+			limb const* b_high = b + h;
+
+			// remainder = [r1 a_low] with one spare limb for the estimate correction below.
+			std::vector<limb> remainder(2 * h + 1, 0);
+			std::copy(a, a + h, remainder.begin());
+			limb* r1 = remainder.data() + h;
+
+			if (compare(a + 2 * h, h, b_high, h) < 0)
+			{
+				div_2n_1n(q, r1, a + h, b_high, h);
+			}
+			else
+			{
+				// The quotient estimate saturates at B^h - 1: r1 = [a_high a_mid] - b_high * B^h + b_high.
+				std::fill(q, q + h, ~limb(0));
+				std::copy(a + h, a + 2 * h, r1);
+				r1[h] = add(r1, r1, h, b_high, h);
+			}
+
+			std::vector<limb> d(2 * h);
+			mul(d.data(), q, h, b_low, h);
+
+			while (compare(remainder.data(), 2 * h + 1, d.data(), 2 * h) < 0)
+			{
+				add(remainder.data(), remainder.data(), 2 * h + 1, b, 2 * h);
+				decrement(q, h);
+			}
+			sub(remainder.data(), remainder.data(), 2 * h + 1, d.data(), 2 * h);
+			std::copy(remainder.begin(), remainder.begin() + 2 * h, r);
+		}
+	}
+
+	limb_divisor::limb_divisor(limb d)
+	: value(d), shift(leading_zeros(d)), normalized(d << shift)
+	{
+		// floor((B^2 - 1) / normalized) - B
+		inverse = static_cast<limb>(((static_cast<double_limb>(~normalized) << limb_bits) | ~limb(0)) / normalized);
+	}
+
+	limb limb_divisor::divide(limb& q, limb high, limb low) const
+	{
+		// Algorithm 4 of Moller and Granlund, "Improved division by invariant integers".
+		double_limb estimate = static_cast<double_limb>(inverse) * high + ((static_cast<double_limb>(high + 1) << limb_bits) | low);
+		limb q1 = static_cast<limb>(estimate >> limb_bits);
+		limb q0 = static_cast<limb>(estimate);
+		limb r = low - q1 * normalized;
+		if (r > q0)
+		{
+			--q1;
+			r += normalized;
+		}
+		if (r >= normalized)
+		{
+			++q1;
+			r -= normalized;
+		}
+		q = q1;
+		return r;
+	}
+
+	limb divrem_1(limb* q, limb const* a, size_t n, limb d)
+	{
+		if (n > 1) return divrem_1(q, a, n, limb_divisor(d));
+
+		double_limb remainder = 0;
+		for (size_t i = n; i-- > 0;)
+		{
+			double_limb current = (remainder << limb_bits) | a[i];
+			q[i] = static_cast<limb>(current / d);
+			remainder = current % d;
+		}
+		return static_cast<limb>(remainder);
+	}
+
+	limb divrem_1(limb* q, limb const* a, size_t n, limb_divisor const& d)
+	{
+		if (n == 0) return 0;
+		if (d.shift == 0)
+		{
+			limb r = 0;
+			for (size_t i = n; i-- > 0;)
+			{
+				r = d.divide(q[i], r, a[i]);
+			}
+			return r;
+		}
+
+		// Divide a << shift by the normalized divisor, shifting the limbs in on the fly.
+		int back = limb_bits - d.shift;
+		limb r = a[n - 1] >> back;
+		for (size_t i = n - 1; i > 0; --i)
+		{
+			limb low = (a[i] << d.shift) | (a[i - 1] >> back);
+			r = d.divide(q[i], r, low);
+		}
+		r = d.divide(q[0], r, a[0] << d.shift);
+		return r >> d.shift;
+	}
+
+	void divrem(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		if (bn == 1)
+		{
+			r[0] = divrem_1(q, a, an, b[0]);
+		}
+		else if (bn >= burnikel_ziegler_threshold && an - bn >= burnikel_ziegler_threshold)
+		{
+			divrem_burnikel_ziegler(q, r, a, an, b, bn);
+		}
+		else
+		{
+			divrem_knuth(q, r, a, an, b, bn);
+		}
+	}
+
+	void divrem_knuth(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		int shift = leading_zeros(b[bn - 1]);
+		std::vector<limb> v(bn), u(an + 1);
+		lshift(v.data(), b, bn, shift);
+		u[an] = lshift(u.data(), a, an, shift);
+
+		double_limb v_top = v[bn - 1];
+		double_limb v_next = v[bn - 2];
+		for (size_t j = an - bn + 1; j-- > 0;)
+		{
+			double_limb numerator = (static_cast<double_limb>(u[j + bn]) << limb_bits) | u[j + bn - 1];
+			double_limb q_hat = numerator / v_top;
+			double_limb r_hat = numerator % v_top;
+			while ((q_hat >> limb_bits) != 0 || q_hat * v_next > ((r_hat << limb_bits) | u[j + bn - 2]))
+			{
+				--q_hat;
+				r_hat += v_top;
+				if ((r_hat >> limb_bits) != 0) break;
+			}
+
+			limb borrow = submul_1(u.data() + j, v.data(), bn, static_cast<limb>(q_hat));
+			limb top = u[j + bn];
+			u[j + bn] = top - borrow;
+			if (top < borrow)
+			{
+				--q_hat;
+				u[j + bn] += add(u.data() + j, u.data() + j, bn, v.data(), bn);
+			}
+			q[j] = static_cast<limb>(q_hat);
+		}
+
+		rshift(r, u.data(), bn, shift);
+	}
+
+	void divrem_burnikel_ziegler(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		// Pad the divisor to n = j * 2^k limbs with j < threshold, so that the recursion halves evenly
+		// down to the schoolbook case, and normalize it so its top bit is set.
+		size_t m = 1;
+		while (m * burnikel_ziegler_threshold <= bn)
+		{
+			m <<= 1;
+		}
+		size_t n = (bn + m - 1) / m * m;
+		size_t limb_shift = n - bn;
+		int bit_shift = leading_zeros(b[bn - 1]);
+
+		std::vector<limb> divisor(n, 0);
+		lshift(divisor.data() + limb_shift, b, bn, bit_shift);
+
+		// The dividend is split into t blocks of n limbs. Its top limb only holds the bits shifted out,
+		// so the top block is always below the normalized divisor.
+		std::vector<limb> dividend(an + limb_shift + 1, 0);
+		dividend[an + limb_shift] = lshift(dividend.data() + limb_shift, a, an, bit_shift);
+		size_t t = std::max<size_t>(2, (dividend.size() + n - 1) / n);
+		dividend.resize(t * n, 0);
+
+		std::vector<limb> quotient((t - 1) * n);
+		std::vector<limb> z(2 * n);
+		std::copy(dividend.begin() + (t - 2) * n, dividend.end(), z.begin());
+		for (size_t i = t - 1; i-- > 0;)
+		{
+			div_2n_1n(quotient.data() + i * n, z.data() + n, z.data(), divisor.data(), n);
+			if (i > 0)
+			{
+				std::copy(dividend.begin() + (i - 1) * n, dividend.begin() + i * n, z.begin());
+			}
+		}
+
+		std::copy(quotient.begin(), quotient.begin() + (an - bn + 1), q);
+		rshift(z.data() + n, z.data() + n, n, bit_shift);
+		std::copy(z.begin() + n + limb_shift, z.begin() + 2 * n, r);
+	}
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "limb_kernels.h"
+
+namespace limbs
+{
+	namespace
+	{
+		limb magnitude(signed_double_limb x)
+		{
+			return static_cast<limb>(x < 0 ? -x : x);
+		}
+
+		limb gcd_1(limb a, limb b)
+		{
+			while (b != 0)
+			{
+				a %= b;
+				std::swap(a, b);
+			}
+			return a;
+		}
+
+		// The Euclidean remainder sequence r0 = x > r1 = y > ... > 0, advanced by Lehmer's algorithm
+		// (Knuth, TAOCP 4.5.2, algorithm L): the quotients the leading limbs agree on are found in single
+		// precision and applied to x and y at once, falling back to a division step when there are none.
+		// With cofactors it also keeps |u_i| for r_i = u_i * r1 (mod r0); u_i is positive for odd i and
+		// negative for even i >= 2.
+		struct remainder_sequence
+		{
+			remainder_sequence(limb const* a, size_t an, limb const* b, size_t bn, bool cofactors)
+			: n(an), x(a, a + an), y(an, 0), next_x(an), next_y(an), cofactors(cofactors), odd(false)
+			{
+				std::copy(b, b + bn, y.begin());
+				if (cofactors)
+				{
+					u.assign(an + 1, 0);
+					v.assign(an + 1, 0);
+					v[0] = 1;
+				}
+			}
+
+			// Until y is zero; x is then the gcd.
+			void run()
+			{
+				for (;;)
+				{
+					size_t yn = normalized_size(y.data(), n);
+					if (yn == 0) return;
+					if (n == 1 && !cofactors)
+					{
+						x[0] = gcd_1(x[0], y[0]);
+						y[0] = 0;
+						return;
+					}
+
+					int shift = leading_zeros(x[n - 1]);
+					signed_double_limb xh = leading(x, shift);
+					signed_double_limb yh = leading(y, shift);
+
+					// [a b; c d] maps (r_i, r_i+1) to (r_i+steps, r_i+steps+1); a, d >= 0 >= b, c or the other way round.
+					signed_double_limb a = 1, b = 0, c = 0, d = 1;
+					size_t steps = 0;
+					while (yh + c != 0 && yh + d != 0)
+					{
+						signed_double_limb q = (xh + a) / (yh + c);
+						if (q != (xh + b) / (yh + d)) break;
+
+						signed_double_limb t = a - q * c;
+						a = c;
+						c = t;
+						t = b - q * d;
+						b = d;
+						d = t;
+						t = xh - q * yh;
+						xh = yh;
+						yh = t;
+						++steps;
+					}
+
+					if (b == 0)
+					{
+						divide(yn);
+					}
+					else
+					{
+						apply(a, b, c, d, steps);
+					}
+				}
+			}
+
+			// The bits of w at the positions of the leading limb_bits bits of x.
+			limb leading(std::vector<limb> const& w, int shift) const
+			{
+				limb high = w[n - 1] << shift;
+				if (shift != 0 && n > 1) high |= w[n - 2] >> (limb_bits - shift);
+				return high;
+			}
+
+			void divide(size_t yn)
+			{
+				std::vector<limb> q(n - yn + 1), r(yn);
+				divrem(q.data(), r.data(), x.data(), n, y.data(), yn);
+				std::swap(x, y);
+				std::fill(y.begin(), y.end(), 0);
+				std::copy(r.begin(), r.end(), y.begin());
+				n = yn;
+
+				if (cofactors)
+				{
+					// u_i+2 = u_i - q * u_i+1, and the signs alternate.
+					std::vector<limb> product(q.size() + v.size());
+					mul(product.data(), q.data(), q.size(), v.data(), v.size());
+					add(product.data(), product.data(), product.size(), u.data(), u.size());
+					std::swap(u, v);
+					std::copy(product.begin(), product.begin() + v.size(), v.begin());
+					odd = !odd;
+				}
+			}
+
+			void apply(signed_double_limb a, signed_double_limb b, signed_double_limb c, signed_double_limb d, size_t steps)
+			{
+				combine(next_x.data(), a, b);
+				combine(next_y.data(), c, d);
+				std::swap(x, next_x);
+				std::swap(y, next_y);
+				n = normalized_size(x.data(), n);
+
+				if (cofactors)
+				{
+					// The two terms have the same sign, so the magnitudes add up.
+					std::vector<limb> next_u(u.size()), next_v(v.size());
+					mul_1(next_u.data(), u.data(), u.size(), magnitude(a));
+					addmul_1(next_u.data(), v.data(), v.size(), magnitude(b));
+					mul_1(next_v.data(), u.data(), u.size(), magnitude(c));
+					addmul_1(next_v.data(), v.data(), v.size(), magnitude(d));
+					std::swap(u, next_u);
+					std::swap(v, next_v);
+					odd = odd != (steps % 2 == 1);
+				}
+			}
+
+			// r = e * x + f * y over n limbs, for e and f of opposite signs and a result that is known to fit.
+			void combine(limb* r, signed_double_limb e, signed_double_limb f) const
+			{
+				if (f <= 0)
+				{
+					mul_1(r, x.data(), n, magnitude(e));
+					submul_1(r, y.data(), n, magnitude(f));
+				}
+				else
+				{
+					mul_1(r, y.data(), n, magnitude(f));
+					submul_1(r, x.data(), n, magnitude(e));
+				}
+				std::fill(r + n, r + x.size(), 0);
+			}
+
+			size_t n;
+			std::vector<limb> x;
+			std::vector<limb> y;
+			std::vector<limb> next_x;
+			std::vector<limb> next_y;
+			bool cofactors;
+			// |u_i| and |u_i+1| for x = r_i and y = r_i+1, and whether i is odd.
+			std::vector<limb> u;
+			std::vector<limb> v;
+			bool odd;
+		};
+	}
+
+	size_t gcd(limb* g, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		an = normalized_size(a, an);
+		bn = normalized_size(b, bn);
+		if (compare(a, an, b, bn) < 0)
+		{
+			std::swap(a, b);
+			std::swap(an, bn);
+		}
+
+		remainder_sequence sequence(a, an, b, bn, false);
+		sequence.run();
+		std::copy(sequence.x.begin(), sequence.x.begin() + sequence.n, g);
+		return sequence.n;
+	}
+
+	bool mod_inverse(limb* r, limb const* a, size_t an, limb const* m, size_t mn)
+	{
+		remainder_sequence sequence(m, mn, a, normalized_size(a, an), true);
+		sequence.run();
+		if (sequence.n != 1 || sequence.x[0] != 1) return false;
+
+		if (sequence.odd)
+		{
+			std::copy(sequence.u.begin(), sequence.u.begin() + mn, r);
+		}
+		else
+		{
+			sub(r, m, mn, sequence.u.data(), mn);
+		}
+		return true;
+	}
+}
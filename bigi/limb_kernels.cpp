@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <vector>
+#include "limb_kernels.h"
+#include "thread_pool.h"
+
+namespace limbs
+{
+	size_t karatsuba_threshold = 32;
+	size_t toom3_threshold = 256;
+
+	namespace
+	{
+		// |a - b| into r (an limbs), an >= bn; returns true if a < b.
+		bool abs_diff(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			if (compare(a, an, b, bn) >= 0)
+			{
+				sub(r, a, an, b, bn);
+				return false;
+			}
+			sub(r, b, bn, a, bn);
+			std::fill(r + bn, r + an, 0);
+			return true;
+		}
+
+		struct signed_number
+		{
+			signed_number()
+			: negative(false)
+			{
+			}
+
+			signed_number(limb const* a, size_t n)
+			: negative(false), magnitude(a, a + normalized_size(a, n))
+			{
+			}
+
+			void normalize()
+			{
+				magnitude.resize(normalized_size(magnitude.data(), magnitude.size()));
+				if (magnitude.empty()) negative = false;
+			}
+
+			bool negative;
+			std::vector<limb> magnitude;
+		};
+
+		signed_number operator+(signed_number const& x, signed_number const& y)
+		{
+			signed_number const& big = x.magnitude.size() >= y.magnitude.size() ? x : y;
+			signed_number const& little = x.magnitude.size() >= y.magnitude.size() ? y : x;
+
+			signed_number result;
+			result.magnitude.resize(big.magnitude.size() + 1);
+			if (x.negative == y.negative)
+			{
+				result.negative = x.negative;
+				result.magnitude.back() = add(result.magnitude.data(), big.magnitude.data(), big.magnitude.size(), little.magnitude.data(), little.magnitude.size());
+			}
+			else
+			{
+				result.negative = abs_diff(result.magnitude.data(), big.magnitude.data(), big.magnitude.size(), little.magnitude.data(), little.magnitude.size()) ? little.negative : big.negative;
+			}
+			result.normalize();
+
+			return result;
+		}
+
+		signed_number operator-(signed_number const& x, signed_number y)
+		{
+			y.negative = !y.negative;
+			return x + y;
+		}
+
+		signed_number operator*(signed_number const& x, signed_number const& y)
+		{
+			signed_number result;
+			if (x.magnitude.empty() || y.magnitude.empty()) return result;
+
+			result.negative = x.negative != y.negative;
+			result.magnitude.resize(x.magnitude.size() + y.magnitude.size());
+			mul(result.magnitude.data(), x.magnitude.data(), x.magnitude.size(), y.magnitude.data(), y.magnitude.size());
+			result.normalize();
+
+			return result;
+		}
+
+		signed_number shift_left_1(signed_number x)
+		{
+			x.magnitude.push_back(0);
+			for (size_t i = x.magnitude.size() - 1; i > 0; --i)
+			{
+				x.magnitude[i] = (x.magnitude[i] << 1) | (x.magnitude[i - 1] >> (limb_bits - 1));
+			}
+			x.magnitude[0] <<= 1;
+			x.normalize();
+
+			return x;
+		}
+
+		signed_number shift_right_1(signed_number x)
+		{
+			for (size_t i = 0; i + 1 < x.magnitude.size(); ++i)
+			{
+				x.magnitude[i] = (x.magnitude[i] >> 1) | (x.magnitude[i + 1] << (limb_bits - 1));
+			}
+			if (!x.magnitude.empty()) x.magnitude.back() >>= 1;
+			x.normalize();
+
+			return x;
+		}
+
+		signed_number divexact_3(signed_number x)
+		{
+			divrem_1(x.magnitude.data(), x.magnitude.data(), x.magnitude.size(), 3);
+			x.normalize();
+
+			return x;
+		}
+
+		void add_shifted(limb* r, size_t rn, size_t shift, signed_number const& x)
+		{
+			add(r + shift, r + shift, rn - shift, x.magnitude.data(), x.magnitude.size());
+		}
+
+		// an >= bn > (an + 1) / 2: both halves of b are nonempty.
+		bool karatsuba_fits(size_t an, size_t bn)
+		{
+			return bn > (an + 1) / 2;
+		}
+
+		// an >= bn > 2 * ceil(an / 3): all thirds of b are nonempty.
+		bool toom3_fits(size_t an, size_t bn)
+		{
+			return bn > 2 * ((an + 2) / 3);
+		}
+
+		// a * b for normalized operands, an >= bn >= 1.
+		void mul_unbalanced(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+		{
+			mul(r, a, bn, b, bn);
+
+			std::vector<limb> t(2 * bn);
+			for (size_t done = bn; done < an; done += bn)
+			{
+				size_t len = std::min(bn, an - done);
+				mul(t.data(), b, bn, a + done, len);
+				std::copy(t.begin() + bn, t.begin() + bn + len, r + done + bn);
+				add(r + done, r + done, bn + len, t.data(), bn);
+			}
+		}
+	}
+
+	int leading_zeros(limb x)
+	{
+#if defined(__GNUC__)
+		return x == 0 ? limb_bits : __builtin_clzll(x) - (64 - limb_bits);
+#else
+		int result = 0;
+		for (limb bit = limb(1) << (limb_bits - 1); bit != 0 && (x & bit) == 0; bit >>= 1)
+		{
+			++result;
+		}
+		return result;
+#endif
+	}
+
+	int trailing_zeros(limb x)
+	{
+#if defined(__GNUC__)
+		return x == 0 ? limb_bits : __builtin_ctzll(x);
+#else
+		int result = 0;
+		for (limb bit = 1; bit != 0 && (x & bit) == 0; bit <<= 1)
+		{
+			++result;
+		}
+		return result;
+#endif
+	}
+
+	int popcount(limb x)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(x);
+#else
+		int result = 0;
+		for (; x != 0; x &= x - 1)
+		{
+			++result;
+		}
+		return result;
+#endif
+	}
+
+	size_t normalized_size(limb const* a, size_t n)
+	{
+		while (n > 0 && a[n - 1] == 0) --n;
+		return n;
+	}
+
+	int compare(limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		an = normalized_size(a, an);
+		bn = normalized_size(b, bn);
+		if (an != bn) return an < bn ? -1 : 1;
+
+		for (size_t i = an; i-- > 0;)
+		{
+			if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	void mul(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		size_t n = an + bn;
+		an = normalized_size(a, an);
+		bn = normalized_size(b, bn);
+		if (an < bn)
+		{
+			std::swap(a, b);
+			std::swap(an, bn);
+		}
+		if (bn == 0)
+		{
+			std::fill(r, r + n, 0);
+			return;
+		}
+		std::fill(r + an + bn, r + n, 0);
+
+		if (bn < karatsuba_threshold)
+		{
+			mul_basecase(r, a, an, b, bn);
+		}
+		else if (bn >= ntt_threshold && ntt_fits(an, bn))
+		{
+			mul_ntt(r, a, an, b, bn);
+		}
+		else if (!karatsuba_fits(an, bn))
+		{
+			mul_unbalanced(r, a, an, b, bn);
+		}
+		else if (bn < toom3_threshold || !toom3_fits(an, bn))
+		{
+			mul_karatsuba(r, a, an, b, bn);
+		}
+		else
+		{
+			mul_toom3(r, a, an, b, bn);
+		}
+	}
+
+	void mul_karatsuba(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		size_t h = (an + 1) / 2;
+		size_t a1n = an - h;
+		size_t b1n = bn - h;
+
+		std::vector<limb> scratch(6 * h + 1);
+		limb* da = scratch.data();
+		limb* db = da + h;
+		limb* middle = db + h;
+		limb* product = middle + 2 * h + 1;
+
+		bool da_negative = abs_diff(da, a, h, a + h, a1n);
+		bool db_negative = abs_diff(db, b, h, b + h, b1n);
+
+		run_parallel(h >= parallel_threshold, {
+			[&] { mul(r, a, h, b, h); },
+			[&] { mul(r + 2 * h, a + h, a1n, b + h, b1n); },
+			[&] { mul(product, da, h, db, h); }});
+
+		// a0 * b1 + a1 * b0 = a0 * b0 + a1 * b1 - (a0 - a1) * (b0 - b1)
+		std::copy(r, r + 2 * h, middle);
+		middle[2 * h] = 0;
+		add(middle, middle, 2 * h + 1, r + 2 * h, a1n + b1n);
+		if (da_negative == db_negative)
+		{
+			sub(middle, middle, 2 * h + 1, product, 2 * h);
+		}
+		else
+		{
+			add(middle, middle, 2 * h + 1, product, 2 * h);
+		}
+
+		add(r + h, r + h, an + bn - h, middle, normalized_size(middle, 2 * h + 1));
+	}
+
+	void sqr(limb* r, limb const* a, size_t n)
+	{
+		size_t rn = 2 * n;
+		n = normalized_size(a, n);
+		std::fill(r + 2 * n, r + rn, 0);
+		if (n == 0) return;
+
+		if (n < karatsuba_threshold)
+		{
+			sqr_basecase(r, a, n);
+		}
+		else if (n < toom3_threshold)
+		{
+			sqr_karatsuba(r, a, n);
+		}
+		else
+		{
+			mul(r, a, n, a, n);
+		}
+	}
+
+	void sqr_karatsuba(limb* r, limb const* a, size_t n)
+	{
+		size_t h = (n + 1) / 2;
+		size_t a1n = n - h;
+
+		std::vector<limb> scratch(5 * h + 1);
+		limb* da = scratch.data();
+		limb* middle = da + h;
+		limb* product = middle + 2 * h + 1;
+
+		abs_diff(da, a, h, a + h, a1n);
+
+		run_parallel(h >= parallel_threshold, {
+			[&] { sqr(r, a, h); },
+			[&] { sqr(r + 2 * h, a + h, a1n); },
+			[&] { sqr(product, da, h); }});
+
+		// 2 * a0 * a1 = a0^2 + a1^2 - (a0 - a1)^2
+		std::copy(r, r + 2 * h, middle);
+		middle[2 * h] = 0;
+		add(middle, middle, 2 * h + 1, r + 2 * h, 2 * a1n);
+		sub(middle, middle, 2 * h + 1, product, 2 * h);
+
+		add(r + h, r + h, 2 * n - h, middle, normalized_size(middle, 2 * h + 1));
+	}
+
+	void mul_toom3(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		size_t k = (an + 2) / 3;
+
+		signed_number a0(a, k), a1(a + k, k), a2(a + 2 * k, an - 2 * k);
+		signed_number b0(b, k), b1(b + k, k), b2(b + 2 * k, bn - 2 * k);
+
+		// Evaluation at 0, 1, -1, -2 and infinity.
+		signed_number pa = a0 + a2;
+		signed_number pb = b0 + b2;
+		signed_number a_1 = pa + a1, b_1 = pb + b1;
+		signed_number a_m1 = pa - a1, b_m1 = pb - b1;
+		signed_number a_m2 = shift_left_1(a_m1 + a2) - a0;
+		signed_number b_m2 = shift_left_1(b_m1 + b2) - b0;
+
+		signed_number r0, r1, r2, r3, r4;
+		run_parallel(k >= parallel_threshold, {
+			[&] { r0 = a0 * b0; },
+			[&] { r1 = a_1 * b_1; },
+			[&] { r2 = a_m1 * b_m1; },
+			[&] { r3 = a_m2 * b_m2; },
+			[&] { r4 = a2 * b2; }});
+
+		// Interpolation (Bodrato's sequence).
+		r3 = divexact_3(r3 - r1);
+		r1 = shift_right_1(r1 - r2);
+		r2 = r2 - r0;
+		r3 = shift_right_1(r2 - r3) + shift_left_1(r4);
+		r2 = r2 + r1 - r4;
+		r1 = r1 - r3;
+
+		size_t n = an + bn;
+		std::fill(r, r + n, 0);
+		add_shifted(r, n, 0, r0);
+		add_shifted(r, n, k, r1);
+		add_shifted(r, n, 2 * k, r2);
+		add_shifted(r, n, 3 * k, r3);
+		add_shifted(r, n, 4 * k, r4);
+	}
+}
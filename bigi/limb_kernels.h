@@ -0,0 +1,229 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Limb width, chosen at build time: 32 (default) or 64, which needs unsigned __int128.
+#if !defined(BIGI_LIMB_BITS)
+#define BIGI_LIMB_BITS 32
+#endif
+
+#if BIGI_LIMB_BITS == 64 && !defined(__SIZEOF_INT128__)
+#error "64-bit limbs need unsigned __int128"
+#elif BIGI_LIMB_BITS != 32 && BIGI_LIMB_BITS != 64
+#error "BIGI_LIMB_BITS must be 32 or 64"
+#endif
+
+// Kernels over unsigned little-endian limb arrays (magnitudes).
+// Output buffers must not overlap the inputs unless stated otherwise.
+namespace limbs
+{
+#if BIGI_LIMB_BITS == 64
+	typedef std::uint64_t limb;
+	typedef unsigned __int128 double_limb;
+	typedef __int128 signed_double_limb;
+#else
+	typedef std::uint32_t limb;
+	typedef std::uint64_t double_limb;
+	typedef std::int64_t signed_double_limb;
+#endif
+
+	const int limb_bits = BIGI_LIMB_BITS;
+
+	// The largest power of ten in a limb; decimal conversion works in chunks of that many digits.
+#if BIGI_LIMB_BITS == 64
+	const limb decimal_base = 10000000000000000000u;
+	const size_t decimal_base_digits = 19;
+#else
+	const limb decimal_base = 1000000000;
+	const size_t decimal_base_digits = 9;
+#endif
+
+	// Operand sizes (in limbs) from which the next multiplication algorithm is used.
+	// All of them can be tuned at runtime.
+	extern size_t karatsuba_threshold;
+	extern size_t toom3_threshold;
+	extern size_t ntt_threshold;
+	// Divisor size (in limbs) from which division uses the Burnikel-Ziegler recursion.
+	extern size_t burnikel_ziegler_threshold;
+	// Size (in limbs) from which decimal conversion splits the number by cached powers of decimal_base.
+	extern size_t radix_threshold;
+	// Multiplication and decimal conversion run independent sub-problems of at least this size (in limbs)
+	// on a work-stealing thread pool, once set_thread_count() allows more than one thread.
+	extern size_t parallel_threshold;
+	// Threads one operation may use, the calling one included; the default of 1 keeps all work on the caller.
+	// Not to be changed while operations are running.
+	void set_thread_count(size_t count);
+	size_t thread_count();
+
+	int leading_zeros(limb x);
+	int trailing_zeros(limb x);
+	int popcount(limb x);
+
+	size_t normalized_size(limb const* a, size_t n);
+	int compare(limb const* a, size_t an, limb const* b, size_t bn);
+
+	// r = a + b, an >= bn, r has an limbs; returns carry. r may be equal to a.
+	limb add(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	// r = a - b, a >= b, an >= bn, r has an limbs; returns borrow. r may be equal to a.
+	limb sub(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+
+	// Two's complement r = a + b and r = a - b, where b is sign extended to an >= bn limbs and the result
+	// wraps around to an limbs. r may be equal to a; then only the limbs that change are written.
+	void add_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	void sub_signed(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	// Two's complement r = -a over n limbs. r may be equal to a.
+	void negate(limb* r, limb const* a, size_t n);
+
+	// r = a * b, r has n limbs; returns high limb. r may be equal to a.
+	limb mul_1(limb* r, limb const* a, size_t n, limb b);
+	// r += a * b over n limbs; returns high limb.
+	limb addmul_1(limb* r, limb const* a, size_t n, limb b);
+	// r -= a * b over n limbs; returns the amount to borrow from the next limb.
+	limb submul_1(limb* r, limb const* a, size_t n, limb b);
+
+	// r = a << shift and r = a >> shift over n limbs, 0 <= shift < limb_bits; return the bits shifted out.
+	// r may overlap a if it lies at or above a for lshift, at or below a for rshift.
+	limb lshift(limb* r, limb const* a, size_t n, int shift);
+	limb rshift(limb* r, limb const* a, size_t n, int shift);
+
+	// Bitwise r = a & b, a | b, a ^ b over n limbs. r may be equal to a.
+	void and_n(limb* r, limb const* a, limb const* b, size_t n);
+	void or_n(limb* r, limb const* a, limb const* b, size_t n);
+	void xor_n(limb* r, limb const* a, limb const* b, size_t n);
+	// r = f(a) over n limbs for the bitwise function f with f(0) = zeros and f(~0) = ones,
+	// e.g. a copy, a fill or a complement. r may be equal to a.
+	void bitwise_map(limb* r, limb const* a, size_t n, limb zeros, limb ones);
+
+	// r = a * b, r has an + bn limbs.
+	void mul(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	void mul_basecase(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	void mul_karatsuba(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	void mul_toom3(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	// r = a * a, r has 2n limbs. Squaring needs about half the limb products of mul.
+	void sqr(limb* r, limb const* a, size_t n);
+	void sqr_basecase(limb* r, limb const* a, size_t n);
+	void sqr_karatsuba(limb* r, limb const* a, size_t n);
+	// Three-prime number-theoretic transform; only valid while ntt_fits(an, bn).
+	bool ntt_fits(size_t an, size_t bn);
+	void mul_ntt(limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+
+	// Arithmetic modulo an odd prime p < 2^31 in Montgomery form with R = 2^32, for the number-theoretic
+	// transform and residue number systems.
+	struct word_prime
+	{
+		typedef std::uint32_t residue;
+		typedef std::uint64_t wide_residue;
+
+		explicit word_prime(residue mod)
+		: mod(mod)
+		{
+			residue inverse = mod;
+			for (int i = 0; i < 5; ++i)
+			{
+				inverse *= 2 - mod * inverse;
+			}
+			negated_inverse = 0 - inverse;
+			wide_residue r = (wide_residue(1) << 32) % mod;
+			r2 = static_cast<residue>(r * r % mod);
+		}
+
+		// t / R mod p for t < p * R.
+		residue reduce(wide_residue t) const
+		{
+			residue m = static_cast<residue>(t) * negated_inverse;
+			residue u = static_cast<residue>((t + static_cast<wide_residue>(m) * mod) >> 32);
+			return u >= mod ? u - mod : u;
+		}
+
+		residue mul(residue a, residue b) const
+		{
+			return reduce(static_cast<wide_residue>(a) * b);
+		}
+
+		residue to_montgomery(residue a) const
+		{
+			return mul(a, r2);
+		}
+
+		residue from_montgomery(residue a) const
+		{
+			return reduce(a);
+		}
+
+		residue add(residue a, residue b) const
+		{
+			residue s = a + b;
+			return s >= mod ? s - mod : s;
+		}
+
+		residue sub(residue a, residue b) const
+		{
+			return a >= b ? a - b : a + mod - b;
+		}
+
+		// Plain (non-Montgomery) modular power.
+		residue pow(residue a, wide_residue e) const
+		{
+			wide_residue result = 1, base = a % mod;
+			for (; e != 0; e >>= 1)
+			{
+				if (e & 1) result = result * base % mod;
+				base = base * base % mod;
+			}
+			return static_cast<residue>(result);
+		}
+
+		residue mod;
+		residue negated_inverse;
+		residue r2;
+	};
+
+	// A single-limb divisor with the reciprocal of Moller and Granlund precomputed,
+	// for dividing many numbers by it without a hardware division per limb.
+	struct limb_divisor
+	{
+		explicit limb_divisor(limb d);
+
+		// q = [high low] / normalized for high < normalized; returns the remainder.
+		limb divide(limb& q, limb high, limb low) const;
+
+		limb value;
+		int shift;
+		limb normalized;
+		limb inverse;
+	};
+
+	// q = a / d, returns a % d. q may be equal to a.
+	limb divrem_1(limb* q, limb const* a, size_t n, limb d);
+	limb divrem_1(limb* q, limb const* a, size_t n, limb_divisor const& d);
+
+	// q = a / b, r = a % b for an >= bn and b[bn - 1] != 0; q has an - bn + 1 limbs, r has bn limbs.
+	void divrem(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	// Knuth's algorithm D, bn >= 2.
+	void divrem_knuth(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+	void divrem_burnikel_ziegler(limb* q, limb* r, limb const* a, size_t an, limb const* b, size_t bn);
+
+	// g = gcd(a, b) for a and b not both zero, by Lehmer's algorithm; g needs max(an, bn) limbs. Returns the size of g.
+	size_t gcd(limb* g, limb const* a, size_t an, limb const* b, size_t bn);
+	// r = a^-1 mod m (mn limbs) for a < m and normalized m > 1; returns false if gcd(a, m) != 1.
+	bool mod_inverse(limb* r, limb const* a, size_t an, limb const* m, size_t mn);
+
+	// Upper bound on the number of decimal digits of an n-limb number.
+	size_t decimal_digits_bound(size_t n);
+	// Writes the decimal digits of a without leading zeros and returns the end of the output,
+	// which needs room for decimal_digits_bound(n) chars.
+	char* to_decimal(limb const* a, size_t n, char* out);
+	std::string to_decimal(limb const* a, size_t n);
+	// Writes the decimal digits of a without leading zeros so that they end at end, overwriting a with zeros, and
+	// returns their start. Quadratic in n, but allocates nothing: meant for short numbers and stack buffers.
+	char* to_decimal_backward(limb* a, size_t n, char* end);
+	// Magnitude of a number given by count digits base decimal_base, most significant first,
+	// or by a string of length decimal digits; without leading zero limbs.
+	std::vector<limb> from_decimal_chunks(limb const* chunks, size_t count);
+	std::vector<limb> from_decimal(char const* s, size_t length);
+	// Parses length decimal digits into r and returns the size of the magnitude, without leading zero limbs.
+	// Quadratic in length, but allocates nothing; r needs room for the magnitude and at least one limb.
+	size_t from_decimal(char const* s, size_t length, limb* r);
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include "limb_backend.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BIGI_SIMD
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BIGI_SIMD
+#endif
+
+namespace limbs
+{
+	namespace
+	{
+#if defined(__AVX2__)
+		typedef __m256i vector;
+
+		inline vector load(limb const* p)
+		{
+			return _mm256_loadu_si256(reinterpret_cast<vector const*>(p));
+		}
+
+		inline void store(limb* p, vector v)
+		{
+			_mm256_storeu_si256(reinterpret_cast<vector*>(p), v);
+		}
+
+		inline vector broadcast(limb x)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm256_set1_epi64x(static_cast<long long>(x));
+#else
+			return _mm256_set1_epi32(static_cast<int>(x));
+#endif
+		}
+
+		inline vector bit_and(vector a, vector b) { return _mm256_and_si256(a, b); }
+		inline vector bit_or(vector a, vector b) { return _mm256_or_si256(a, b); }
+		inline vector bit_xor(vector a, vector b) { return _mm256_xor_si256(a, b); }
+		// ~a & b
+		inline vector bit_andnot(vector a, vector b) { return _mm256_andnot_si256(a, b); }
+
+		// Each limb shifted by count bits.
+		inline vector shift_left(vector v, __m128i count)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm256_sll_epi64(v, count);
+#else
+			return _mm256_sll_epi32(v, count);
+#endif
+		}
+
+		inline vector shift_right(vector v, __m128i count)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm256_srl_epi64(v, count);
+#else
+			return _mm256_srl_epi32(v, count);
+#endif
+		}
+#elif defined(BIGI_SIMD)
+		typedef __m128i vector;
+
+		inline vector load(limb const* p)
+		{
+			return _mm_loadu_si128(reinterpret_cast<vector const*>(p));
+		}
+
+		inline void store(limb* p, vector v)
+		{
+			_mm_storeu_si128(reinterpret_cast<vector*>(p), v);
+		}
+
+		inline vector broadcast(limb x)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm_set1_epi64x(static_cast<long long>(x));
+#else
+			return _mm_set1_epi32(static_cast<int>(x));
+#endif
+		}
+
+		inline vector bit_and(vector a, vector b) { return _mm_and_si128(a, b); }
+		inline vector bit_or(vector a, vector b) { return _mm_or_si128(a, b); }
+		inline vector bit_xor(vector a, vector b) { return _mm_xor_si128(a, b); }
+		inline vector bit_andnot(vector a, vector b) { return _mm_andnot_si128(a, b); }
+
+		inline vector shift_left(vector v, __m128i count)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm_sll_epi64(v, count);
+#else
+			return _mm_sll_epi32(v, count);
+#endif
+		}
+
+		inline vector shift_right(vector v, __m128i count)
+		{
+#if BIGI_LIMB_BITS == 64
+			return _mm_srl_epi64(v, count);
+#else
+			return _mm_srl_epi32(v, count);
+#endif
+		}
+#endif
+
+#if defined(BIGI_SIMD)
+		const size_t vector_limbs = sizeof(vector) / sizeof(limb);
+#endif
+	}
+
+	namespace kernel
+	{
+		void and_n(limb* r, limb const* a, limb const* b, size_t n)
+		{
+			size_t i = 0;
+#if defined(BIGI_SIMD)
+			for (; i + vector_limbs <= n; i += vector_limbs)
+			{
+				store(r + i, bit_and(load(a + i), load(b + i)));
+			}
+#endif
+			for (; i < n; ++i)
+			{
+				r[i] = a[i] & b[i];
+			}
+		}
+
+		void or_n(limb* r, limb const* a, limb const* b, size_t n)
+		{
+			size_t i = 0;
+#if defined(BIGI_SIMD)
+			for (; i + vector_limbs <= n; i += vector_limbs)
+			{
+				store(r + i, bit_or(load(a + i), load(b + i)));
+			}
+#endif
+			for (; i < n; ++i)
+			{
+				r[i] = a[i] | b[i];
+			}
+		}
+
+		void xor_n(limb* r, limb const* a, limb const* b, size_t n)
+		{
+			size_t i = 0;
+#if defined(BIGI_SIMD)
+			for (; i + vector_limbs <= n; i += vector_limbs)
+			{
+				store(r + i, bit_xor(load(a + i), load(b + i)));
+			}
+#endif
+			for (; i < n; ++i)
+			{
+				r[i] = a[i] ^ b[i];
+			}
+		}
+
+		void bitwise_map(limb* r, limb const* a, size_t n, limb zeros, limb ones)
+		{
+			if (r == a && zeros == 0 && ones == ~limb(0)) return;
+
+			// Each bit of the result is taken from ones where a has a one and from zeros elsewhere.
+			size_t i = 0;
+#if defined(BIGI_SIMD)
+			vector zeros_vector = broadcast(zeros);
+			vector ones_vector = broadcast(ones);
+			for (; i + vector_limbs <= n; i += vector_limbs)
+			{
+				vector x = load(a + i);
+				store(r + i, bit_or(bit_and(x, ones_vector), bit_andnot(x, zeros_vector)));
+			}
+#endif
+			for (; i < n; ++i)
+			{
+				r[i] = (a[i] & ones) | (~a[i] & zeros);
+			}
+		}
+
+		limb lshift(limb* r, limb const* a, size_t n, int shift)
+		{
+			if (n == 0) return 0;
+			if (shift == 0)
+			{
+				std::copy_backward(a, a + n, r + n);
+				return 0;
+			}
+
+			// Runs from the top down, so r may also lie above a.
+			limb out = a[n - 1] >> (limb_bits - shift);
+			size_t i = n - 1;
+#if defined(BIGI_SIMD)
+			__m128i left = _mm_cvtsi32_si128(shift);
+			__m128i right = _mm_cvtsi32_si128(limb_bits - shift);
+			for (; i >= vector_limbs; i -= vector_limbs)
+			{
+				size_t low = i + 1 - vector_limbs;
+				vector high_part = shift_left(load(a + low), left);
+				vector low_part = shift_right(load(a + low - 1), right);
+				store(r + low, bit_or(high_part, low_part));
+			}
+#endif
+			for (; i > 0; --i)
+			{
+				r[i] = (a[i] << shift) | (a[i - 1] >> (limb_bits - shift));
+			}
+			r[0] = a[0] << shift;
+			return out;
+		}
+
+		limb rshift(limb* r, limb const* a, size_t n, int shift)
+		{
+			if (n == 0) return 0;
+			if (shift == 0)
+			{
+				std::copy(a, a + n, r);
+				return 0;
+			}
+
+			// Runs from the bottom up, so r may also lie below a.
+			limb out = a[0] << (limb_bits - shift);
+			size_t i = 0;
+#if defined(BIGI_SIMD)
+			__m128i right = _mm_cvtsi32_si128(shift);
+			__m128i left = _mm_cvtsi32_si128(limb_bits - shift);
+			for (; i + vector_limbs < n; i += vector_limbs)
+			{
+				vector low_part = shift_right(load(a + i), right);
+				vector high_part = shift_left(load(a + i + 1), left);
+				store(r + i, bit_or(low_part, high_part));
+			}
+#endif
+			for (; i + 1 < n; ++i)
+			{
+				r[i] = (a[i] >> shift) | (a[i + 1] << (limb_bits - shift));
+			}
+			r[n - 1] = a[n - 1] >> shift;
+			return out;
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <vector>
+#include "limb_kernels.h"
+#include "thread_pool.h"
+
+namespace limbs
+{
+	namespace
+	{
+		typedef word_prime::residue residue;
+		typedef word_prime::wide_residue wide_residue;
+		// The transforms work on 32-bit pieces of the limbs, so that the convolution bound does not
+		// depend on the limb width.
+		typedef std::uint32_t digit;
+		const int digit_bits = 32;
+		const size_t digits_per_limb = limb_bits / digit_bits;
+
+		// All three primes have primitive root 3 and support lengths up to 2^23.
+		const residue primes[3] = { 998244353, 167772161, 469762049 };
+		const residue primitive_root = 3;
+		const size_t max_ntt_length = size_t(1) << 23;
+
+		void transform(std::vector<residue>& a, word_prime const& prime, bool inverse)
+		{
+			// A local copy lets the compiler keep the modulus in registers: stores into a could alias prime.
+			word_prime const p = prime;
+			size_t n = a.size();
+			for (size_t i = 1, j = 0; i < n; ++i)
+			{
+				size_t bit = n >> 1;
+				for (; j & bit; bit >>= 1)
+				{
+					j ^= bit;
+				}
+				j ^= bit;
+				if (i < j) std::swap(a[i], a[j]);
+			}
+
+			std::vector<residue> roots(n / 2);
+			for (size_t length = 2; length <= n; length <<= 1)
+			{
+				size_t half = length / 2;
+				residue root = p.pow(primitive_root, (p.mod - 1) / length);
+				if (inverse) root = p.pow(root, p.mod - 2);
+				root = p.to_montgomery(root);
+
+				roots[0] = p.to_montgomery(1);
+				for (size_t j = 1; j < half; ++j)
+				{
+					roots[j] = p.mul(roots[j - 1], root);
+				}
+
+				for (size_t i = 0; i < n; i += length)
+				{
+					residue* lo = &a[i];
+					residue* hi = lo + half;
+					for (size_t j = 0; j < half; ++j)
+					{
+						residue u = lo[j];
+						residue v = p.mul(hi[j], roots[j]);
+						lo[j] = p.add(u, v);
+						hi[j] = p.sub(u, v);
+					}
+				}
+			}
+		}
+
+		// Cyclic convolution of a and b modulo p, written over fa.
+		void convolve(std::vector<residue>& fa, digit const* a, size_t an, digit const* b, size_t bn, size_t n, word_prime const& p)
+		{
+			fa.assign(n, 0);
+			for (size_t i = 0; i < an; ++i)
+			{
+				fa[i] = a[i] % p.mod;
+			}
+			transform(fa, p, false);
+
+			if (a == b && an == bn)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					fa[i] = p.mul(fa[i], fa[i]);
+				}
+			}
+			else
+			{
+				std::vector<residue> fb(n, 0);
+				for (size_t i = 0; i < bn; ++i)
+				{
+					fb[i] = b[i] % p.mod;
+				}
+				transform(fb, p, false);
+				for (size_t i = 0; i < n; ++i)
+				{
+					fa[i] = p.mul(fa[i], fb[i]);
+				}
+			}
+
+			transform(fa, p, true);
+
+			// Undo both the 1/R of the pointwise product and the factor n of the inverse transform.
+			residue scale = static_cast<residue>(static_cast<wide_residue>(p.pow(static_cast<residue>(n % p.mod), p.mod - 2)) * p.r2 % p.mod);
+			for (size_t i = 0; i < n; ++i)
+			{
+				fa[i] = p.mul(fa[i], scale);
+			}
+		}
+	}
+
+	size_t ntt_threshold = 6000;
+
+	bool ntt_fits(size_t an, size_t bn)
+	{
+		return (an + bn) * digits_per_limb <= max_ntt_length;
+	}
+
+	void mul_ntt(limb* r, limb const* a, size_t an, limb const* b, size_t bn)
+	{
+		std::vector<digit> da(an * digits_per_limb), db(bn * digits_per_limb), dr((an + bn) * digits_per_limb);
+		for (size_t i = 0; i < da.size(); ++i)
+		{
+			da[i] = static_cast<digit>(a[i / digits_per_limb] >> (i % digits_per_limb * digit_bits));
+		}
+		for (size_t i = 0; i < db.size(); ++i)
+		{
+			db[i] = static_cast<digit>(b[i / digits_per_limb] >> (i % digits_per_limb * digit_bits));
+		}
+		bool square = a == b && an == bn;
+		bool parallel = std::min(an, bn) >= parallel_threshold;
+		an = da.size();
+		bn = db.size();
+		digit const* a_digits = da.data();
+		digit const* b_digits = square ? a_digits : db.data();
+
+		size_t n = 1;
+		while (n < an + bn - 1)
+		{
+			n <<= 1;
+		}
+
+		word_prime p0(primes[0]), p1(primes[1]), p2(primes[2]);
+		std::vector<residue> c0, c1, c2;
+		run_parallel(parallel, {
+			[&] { convolve(c0, a_digits, an, b_digits, bn, n, p0); },
+			[&] { convolve(c1, a_digits, an, b_digits, bn, n, p1); },
+			[&] { convolve(c2, a_digits, an, b_digits, bn, n, p2); }});
+
+		// Garner's reconstruction: x = v0 + p0 * (v1 + p1 * v2) < p0 * p1 * p2.
+		const residue p0_inverse_mod_p1 = p1.pow(primes[0], primes[1] - 2);
+		const residue p0_inverse_mod_p2 = p2.pow(primes[0], primes[2] - 2);
+		const residue p1_inverse_mod_p2 = p2.pow(primes[1], primes[2] - 2);
+
+		wide_residue carry = 0;
+		for (size_t i = 0; i < an + bn; ++i)
+		{
+			if (i < n)
+			{
+				residue v0 = c0[i];
+				residue v1 = static_cast<residue>(static_cast<wide_residue>(p1.sub(c1[i], v0 % primes[1])) * p0_inverse_mod_p1 % primes[1]);
+				residue v2 = static_cast<residue>(static_cast<wide_residue>(p2.sub(c2[i], v0 % primes[2])) * p0_inverse_mod_p2 % primes[2]);
+				v2 = static_cast<residue>(static_cast<wide_residue>(p2.sub(v2, v1 % primes[2])) * p1_inverse_mod_p2 % primes[2]);
+
+				wide_residue t = v1 + static_cast<wide_residue>(primes[1]) * v2;
+				wide_residue low = static_cast<wide_residue>(primes[0]) * static_cast<digit>(t) + v0;
+				wide_residue middle = static_cast<wide_residue>(primes[0]) * (t >> digit_bits);
+				wide_residue high = middle >> digit_bits;
+				middle <<= digit_bits;
+				low += middle;
+				if (low < middle) ++high;
+
+				low += carry;
+				if (low < carry) ++high;
+				dr[i] = static_cast<digit>(low);
+				carry = (low >> digit_bits) | (high << digit_bits);
+			}
+			else
+			{
+				dr[i] = static_cast<digit>(carry);
+				carry >>= digit_bits;
+			}
+		}
+
+		std::fill(r, r + (an + bn) / digits_per_limb, 0);
+		for (size_t i = 0; i < dr.size(); ++i)
+		{
+			r[i / digits_per_limb] |= static_cast<limb>(dr[i]) << (i % digits_per_limb * digit_bits);
+		}
+	}
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "limb_kernels.h"
+#include "thread_pool.h"
+
+namespace limbs
+{
+	size_t radix_threshold = 40;
+
+	namespace
+	{
+		// decimal_base^(2^k), grown on demand. A deque keeps references to earlier entries valid while it grows.
+		std::vector<limb> const& decimal_power(size_t k)
+		{
+			static std::deque<std::vector<limb>> powers(1, std::vector<limb>(1, decimal_base));
+			static std::mutex mutex;
+
+			std::unique_lock<std::mutex> lock(mutex);
+			while (powers.size() <= k)
+			{
+				// The squaring may wait for the thread pool, which runs other conversions needing powers
+				// meanwhile, so it happens unlocked. A thread that loses the race drops its square.
+				size_t size = powers.size();
+				std::vector<limb> const& last = powers.back();
+				lock.unlock();
+
+				std::vector<limb> square(2 * last.size());
+				sqr(square.data(), last.data(), last.size());
+				square.resize(normalized_size(square.data(), square.size()));
+
+				lock.lock();
+				if (powers.size() == size) powers.push_back(std::move(square));
+			}
+			return powers[k];
+		}
+
+		// The largest k with decimal_base^(2^k) at most half as long as a number of n limbs.
+		size_t split_power(size_t n)
+		{
+			size_t k = 0;
+			while (decimal_power(k + 1).size() * 2 <= n)
+			{
+				++k;
+			}
+			return k;
+		}
+
+		char* write_padding(char* out, size_t digits, size_t width)
+		{
+			return width > digits ? std::fill_n(out, width - digits, '0') : out;
+		}
+
+		char* write_chunk(char* out, limb chunk, size_t width)
+		{
+			char buffer[decimal_base_digits];
+			size_t length = 0;
+			do
+			{
+				buffer[length++] = static_cast<char>('0' + chunk % 10);
+				chunk /= 10;
+			} while (chunk != 0);
+
+			out = write_padding(out, length, width);
+			return std::reverse_copy(buffer, buffer + length, out);
+		}
+
+		char* write_simple(limb const* a, size_t n, char* out, size_t width)
+		{
+			static const limb_divisor base_divisor(decimal_base);
+
+			std::vector<limb> t(a, a + n);
+			std::vector<limb> chunks;
+			while (n > 0)
+			{
+				chunks.push_back(divrem_1(t.data(), t.data(), n, base_divisor));
+				n = normalized_size(t.data(), n);
+			}
+			if (chunks.empty()) return write_padding(out, 0, width);
+
+			size_t top_digits = 1;
+			for (limb top = chunks.back(); top >= 10; top /= 10)
+			{
+				++top_digits;
+			}
+			out = write_padding(out, top_digits + decimal_base_digits * (chunks.size() - 1), width);
+			for (auto it = chunks.crbegin(); it != chunks.crend(); ++it)
+			{
+				out = write_chunk(out, *it, it == chunks.crbegin() ? 0 : decimal_base_digits);
+			}
+			return out;
+		}
+
+		// Writes a in decimal, padded with leading zeros to width digits.
+		char* write_decimal(limb const* a, size_t n, char* out, size_t width)
+		{
+			n = normalized_size(a, n);
+			if (n < radix_threshold || n < 2)
+			{
+				return write_simple(a, n, out, width);
+			}
+
+			size_t k = split_power(n);
+			std::vector<limb> const& power = decimal_power(k);
+			std::vector<limb> q(n - power.size() + 1), r(power.size());
+			divrem(q.data(), r.data(), a, n, power.data(), power.size());
+
+			size_t low_digits = decimal_base_digits << k;
+			size_t high_width = width > low_digits ? width - low_digits : 0;
+			if (n < parallel_threshold || thread_count() == 1)
+			{
+				out = write_decimal(q.data(), q.size(), out, high_width);
+				return write_decimal(r.data(), r.size(), out, low_digits);
+			}
+
+			// The low part always takes low_digits digits, so it can be written aside at the same time.
+			std::string low(low_digits, '0');
+			run_parallel(true, {
+				[&] { out = write_decimal(q.data(), q.size(), out, high_width); },
+				[&] { write_decimal(r.data(), r.size(), &low[0], low_digits); }});
+			return std::copy(low.cbegin(), low.cend(), out);
+		}
+
+		limb parse_chunk(char const* s, size_t length)
+		{
+			limb result = 0;
+			for (size_t i = 0; i < length; ++i)
+			{
+				result = result * 10 + (s[i] - '0');
+			}
+			return result;
+		}
+
+		std::vector<limb> read_simple(limb const* chunks, size_t count)
+		{
+			std::vector<limb> result(1, 0);
+			for (size_t i = 0; i < count; ++i)
+			{
+				limb carry = mul_1(result.data(), result.data(), result.size(), decimal_base);
+				carry += add(result.data(), result.data(), result.size(), &chunks[i], 1);
+				if (carry != 0) result.push_back(carry);
+			}
+			result.resize(normalized_size(result.data(), result.size()));
+			return result;
+		}
+	}
+
+	size_t decimal_digits_bound(size_t n)
+	{
+		// 32 * log10(2) < 9.633
+		return n * (limb_bits / 32) * 9633 / 1000 + 2;
+	}
+
+	char* to_decimal(limb const* a, size_t n, char* out)
+	{
+		return write_decimal(a, n, out, 1);
+	}
+
+	std::string to_decimal(limb const* a, size_t n)
+	{
+		std::string result(decimal_digits_bound(n), '0');
+		result.resize(to_decimal(a, n, &result[0]) - &result[0]);
+		return result;
+	}
+
+	char* to_decimal_backward(limb* a, size_t n, char* end)
+	{
+		static const limb_divisor base_divisor(decimal_base);
+
+		n = normalized_size(a, n);
+		if (n == 0)
+		{
+			*--end = '0';
+			return end;
+		}
+		while (n > 0)
+		{
+			limb chunk = divrem_1(a, a, n, base_divisor);
+			n = normalized_size(a, n);
+			// Full chunks below the top one keep their leading zeros.
+			for (size_t i = 0; i < decimal_base_digits && (n > 0 || chunk != 0); ++i)
+			{
+				*--end = static_cast<char>('0' + chunk % 10);
+				chunk /= 10;
+			}
+		}
+		return end;
+	}
+
+	std::vector<limb> from_decimal_chunks(limb const* chunks, size_t count)
+	{
+		if (count < radix_threshold || count < 2)
+		{
+			return read_simple(chunks, count);
+		}
+
+		size_t k = 0;
+		while ((size_t(2) << (k + 1)) <= count)
+		{
+			++k;
+		}
+		size_t low_count = size_t(1) << k;
+
+		std::vector<limb> high, low;
+		run_parallel(count >= parallel_threshold, {
+			[&] { high = from_decimal_chunks(chunks, count - low_count); },
+			[&] { low = from_decimal_chunks(chunks + count - low_count, low_count); }});
+		std::vector<limb> const& power = decimal_power(k);
+
+		std::vector<limb> result(high.size() + power.size() + 1, 0);
+		mul(result.data(), high.data(), high.size(), power.data(), power.size());
+		add(result.data(), result.data(), result.size(), low.data(), low.size());
+		result.resize(normalized_size(result.data(), result.size()));
+
+		return result;
+	}
+
+	std::vector<limb> from_decimal(char const* s, size_t length)
+	{
+		std::vector<limb> chunks;
+		size_t first = length % decimal_base_digits == 0 ? decimal_base_digits : length % decimal_base_digits;
+		for (size_t i = 0; i < length; i = i == 0 ? first : i + decimal_base_digits)
+		{
+			chunks.push_back(parse_chunk(s + i, i == 0 ? first : decimal_base_digits));
+		}
+		return from_decimal_chunks(chunks.data(), chunks.size());
+	}
+
+	size_t from_decimal(char const* s, size_t length, limb* r)
+	{
+		size_t n = 1;
+		r[0] = 0;
+		size_t first = length % decimal_base_digits == 0 ? decimal_base_digits : length % decimal_base_digits;
+		for (size_t i = 0; i < length; i = i == 0 ? first : i + decimal_base_digits)
+		{
+			limb chunk = parse_chunk(s + i, i == 0 ? first : decimal_base_digits);
+			limb carry = mul_1(r, r, n, decimal_base);
+			carry += add(r, r, n, &chunk, 1);
+			if (carry != 0) r[n++] = carry;
+		}
+		return normalized_size(r, n);
+	}
+}
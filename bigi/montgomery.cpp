@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <stdexcept>
+#include "montgomery.h"
+
+using limbs::limb;
+using limbs::limb_bits;
+
+namespace
+{
+	// Window size for an exponent of the given length, as in OpenSSL.
+	int window_bits(size_t bits)
+	{
+		return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 4 ? 2 : 1;
+	}
+
+	// Left-to-right sliding window exponentiation over any multiplication multiply(r, x, y), which must
+	// allow r to be x or y.
+	template <typename T, typename Multiply>
+	T window_pow(T const& base, T const& one, std::vector<limb> const& e, Multiply multiply)
+	{
+		size_t bits = e.empty() ? 0 : e.size() * limb_bits - limbs::leading_zeros(e.back());
+		if (bits == 0) return one;
+
+		auto bit = [&e](size_t i) { return (e[i / limb_bits] >> (i % limb_bits)) & 1; };
+
+		// odd[k] = base^(2k + 1)
+		int w = window_bits(bits);
+		std::vector<T> odd(size_t(1) << (w - 1), base);
+		if (odd.size() > 1)
+		{
+			T square = base;
+			multiply(square, base, base);
+			for (size_t k = 1; k < odd.size(); ++k)
+			{
+				multiply(odd[k], odd[k - 1], square);
+			}
+		}
+
+		T result = one;
+		bool started = false;
+		for (size_t i = bits; i > 0;)
+		{
+			size_t top = i - 1;
+			if (bit(top) == 0)
+			{
+				if (started) multiply(result, result, result);
+				i = top;
+				continue;
+			}
+
+			// The longest window of at most w bits that starts at top and ends with a one.
+			size_t low = top + 1 >= static_cast<size_t>(w) ? top + 1 - w : 0;
+			while (bit(low) == 0)
+			{
+				++low;
+			}
+			size_t window = 0;
+			for (size_t j = top + 1; j-- > low;)
+			{
+				window = window << 1 | bit(j);
+				if (started) multiply(result, result, result);
+			}
+
+			if (started)
+			{
+				multiply(result, result, odd[window >> 1]);
+			}
+			else
+			{
+				result = odd[window >> 1];
+			}
+			started = true;
+			i = low;
+		}
+		return result;
+	}
+}
+
+montgomery_context::montgomery_context(big_integer const& modulus)
+: modulus(modulus)
+{
+	if (modulus <= 0 || (modulus & 1) == 0) throw std::runtime_error("montgomery modulus must be odd and positive");
+
+	m = magnitude(modulus);
+	size_t n = m.size();
+
+	// Newton's iteration doubles the number of correct low bits of m[0]^-1, starting from 3.
+	limb inverse = m[0];
+	for (int i = 0; i < 5; ++i)
+	{
+		inverse *= 2 - m[0] * inverse;
+	}
+	negated_inverse = 0 - inverse;
+
+	residue power(2 * n + 1, 0), q(n + 2);
+	power[2 * n] = 1;
+	r2.resize(n);
+	limbs::divrem(q.data(), r2.data(), power.data(), 2 * n + 1, m.data(), n);
+	power.assign(n + 1, 0);
+	power[n] = 1;
+	r1.resize(n);
+	limbs::divrem(q.data(), r1.data(), power.data(), n + 1, m.data(), n);
+}
+
+big_integer montgomery_context::to_montgomery(big_integer const& a) const
+{
+	big_integer reduced = a % modulus;
+	if (reduced < 0) reduced += modulus;
+
+	residue x = load(reduced), r(m.size()), scratch;
+	multiply(r.data(), x.data(), r2.data(), scratch);
+	return store(r);
+}
+
+big_integer montgomery_context::from_montgomery(big_integer const& a) const
+{
+	residue t = load(a), r(m.size());
+	t.resize(2 * m.size() + 1, 0);
+	reduce(r.data(), t.data());
+	return store(r);
+}
+
+big_integer montgomery_context::one() const
+{
+	return store(r1);
+}
+
+big_integer montgomery_context::mul(big_integer const& a, big_integer const& b) const
+{
+	residue x = load(a), y = load(b), r(m.size()), scratch;
+	multiply(r.data(), x.data(), y.data(), scratch);
+	return store(r);
+}
+
+big_integer montgomery_context::sqr(big_integer const& a) const
+{
+	residue x = load(a), r(m.size()), scratch;
+	multiply(r.data(), x.data(), x.data(), scratch);
+	return store(r);
+}
+
+big_integer montgomery_context::pow(big_integer const& a, big_integer const& e) const
+{
+	if (e < 0) throw std::runtime_error("negative exponent");
+
+	residue scratch;
+	residue result = window_pow(load(a), r1, magnitude(e), [this, &scratch](residue& r, residue const& x, residue const& y)
+	{
+		multiply(r.data(), x.data(), y.data(), scratch);
+	});
+	return store(result);
+}
+
+montgomery_context::residue montgomery_context::magnitude(big_integer const& a)
+{
+	return a.magnitude();
+}
+
+montgomery_context::residue montgomery_context::load(big_integer const& a) const
+{
+	residue result = magnitude(a);
+	result.resize(m.size(), 0);
+	return result;
+}
+
+big_integer montgomery_context::store(residue const& a) const
+{
+	big_integer result;
+	result.set_magnitude(a.data(), a.size(), false);
+	return result;
+}
+
+void montgomery_context::multiply(limb* r, limb const* a, limb const* b, residue& scratch) const
+{
+	size_t n = m.size();
+	scratch.resize(2 * n + 1);
+	scratch[2 * n] = 0;
+	if (a == b)
+	{
+		limbs::sqr(scratch.data(), a, n);
+	}
+	else
+	{
+		limbs::mul(scratch.data(), a, n, b, n);
+	}
+	reduce(r, scratch.data());
+}
+
+void montgomery_context::reduce(limb* r, limb* t) const
+{
+	// Adding u * m clears the low limb; after n steps t is divisible by R and t / R < 2m.
+	// The carry out of step i belongs at limb i + n and is parked in the cleared limb i, to be added at the end.
+	size_t n = m.size();
+	for (size_t i = 0; i < n; ++i)
+	{
+		t[i] = limbs::addmul_1(t + i, m.data(), n, t[i] * negated_inverse);
+	}
+	t[2 * n] = limbs::add(t + n, t + n, n, t, n);
+	if (limbs::compare(t + n, n + 1, m.data(), n) >= 0)
+	{
+		limbs::sub(t + n, t + n, n + 1, m.data(), n);
+	}
+	std::copy(t + n, t + 2 * n, r);
+}
+
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod)
+{
+	if (mod == 0) throw std::runtime_error("division by zero");
+	if (exp < 0) throw std::runtime_error("negative exponent");
+
+	big_integer m = mod < 0 ? -mod : mod;
+	if (m == 1) return 0;
+	if ((m & 1) != 0)
+	{
+		montgomery_context context(m);
+		return context.from_montgomery(context.pow(context.to_montgomery(base), exp));
+	}
+
+	big_integer reduced = base % m;
+	if (reduced < 0) reduced += m;
+	return window_pow(reduced, big_integer(1), montgomery_context::magnitude(exp), [&m](big_integer& r, big_integer const& x, big_integer const& y)
+	{
+		r = x * y % m;
+	});
+}
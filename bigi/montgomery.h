@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// Arithmetic modulo an odd m > 0 on numbers in Montgomery form x * R mod m, where R = B^n for the n limbs of m.
+// Values stay in that form across chains of mul / sqr / pow; to_montgomery and from_montgomery convert at the ends.
+struct montgomery_context
+{
+	explicit montgomery_context(big_integer const& modulus);
+
+	// Takes any a and reduces it modulo m first.
+	big_integer to_montgomery(big_integer const& a) const;
+
+	// The functions below take numbers in Montgomery form, in [0, m).
+	big_integer from_montgomery(big_integer const& a) const;
+	big_integer one() const;
+	big_integer mul(big_integer const& a, big_integer const& b) const;
+	big_integer sqr(big_integer const& a) const;
+	// a^e for e >= 0 by sliding window exponentiation.
+	big_integer pow(big_integer const& a, big_integer const& e) const;
+
+	friend big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
+
+private:
+	typedef std::vector<limbs::limb> residue;
+
+	static residue magnitude(big_integer const& a);
+	residue load(big_integer const& a) const;
+	big_integer store(residue const& a) const;
+
+	// r = a * b / R mod m, r may be equal to a or b; scratch is resized as needed.
+	void multiply(limbs::limb* r, limbs::limb const* a, limbs::limb const* b, residue& scratch) const;
+	// r = t / R mod m for t < m * R of 2n + 1 limbs; t is overwritten.
+	void reduce(limbs::limb* r, limbs::limb* t) const;
+
+	big_integer modulus;
+	residue m;
+	limbs::limb negated_inverse;
+	// R mod m and R^2 mod m.
+	residue r1;
+	residue r2;
+};
+
+// base^exp mod |mod|, in [0, |mod|), for exp >= 0. Odd moduli go through montgomery_context,
+// even ones reduce each product by division.
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <limits>
+#include "product_tree.h"
+#include "limb_kernels.h"
+
+using limbs::limb;
+
+namespace
+{
+	big_integer product(std::vector<big_integer> const& factors, size_t first, size_t last)
+	{
+		if (last - first == 1) return factors[first];
+
+		size_t middle = first + (last - first) / 2;
+		return product(factors, first, middle) * product(factors, middle, last);
+	}
+
+	// Collects small factors, multiplied together while the product fits in a limb, so that the leaves of the
+	// tree are full limbs rather than single small numbers.
+	struct factor_list
+	{
+		factor_list()
+		: word(1)
+		{
+		}
+
+		void push(limb x)
+		{
+			if (word > std::numeric_limits<limb>::max() / x)
+			{
+				factors.push_back(big_integer(word));
+				word = x;
+			}
+			else
+			{
+				word *= x;
+			}
+		}
+
+		void push(big_integer x)
+		{
+			factors.push_back(std::move(x));
+		}
+
+		big_integer product()
+		{
+			if (word != 1) factors.push_back(big_integer(word));
+			word = 1;
+			return ::product(factors);
+		}
+
+		std::vector<big_integer> factors;
+		limb word;
+	};
+
+	// The odd primes up to n by a sieve over the odd numbers.
+	std::vector<unsigned> odd_primes(unsigned n)
+	{
+		std::vector<unsigned> result;
+		std::vector<char> composite(n / 2 + 1, 0);
+		for (unsigned long long i = 3; i <= n; i += 2)
+		{
+			if (composite[i / 2]) continue;
+			result.push_back(static_cast<unsigned>(i));
+			for (unsigned long long j = i * i; j <= n; j += 2 * i)
+			{
+				composite[j / 2] = 1;
+			}
+		}
+		return result;
+	}
+
+	// The exponent of p in n!, by Legendre's formula.
+	unsigned legendre(unsigned n, unsigned p)
+	{
+		unsigned result = 0;
+		for (unsigned q = n / p; q != 0; q /= p)
+		{
+			result += q;
+		}
+		return result;
+	}
+
+	// p^e, straight into the list while it fits in a limb and by repeated squaring beyond that.
+	void push_power(factor_list& factors, unsigned p, unsigned e)
+	{
+		if (e == 0) return;
+
+		limb power = p;
+		unsigned used = 1;
+		while (used < e && power <= std::numeric_limits<limb>::max() / p)
+		{
+			power *= p;
+			++used;
+		}
+		if (used == e)
+		{
+			factors.push(power);
+		}
+		else
+		{
+			factors.push(pow(big_integer(p), e));
+		}
+	}
+
+	// The product of the integers in [low, high].
+	big_integer range_product(unsigned low, unsigned high)
+	{
+		factor_list factors;
+		for (unsigned long long i = low; i <= high; ++i)
+		{
+			factors.push(static_cast<limb>(i));
+		}
+		return factors.product();
+	}
+}
+
+big_integer product(std::vector<big_integer> const& factors)
+{
+	if (factors.empty()) return 1;
+	return product(factors, 0, factors.size());
+}
+
+big_integer factorial(unsigned n)
+{
+	factor_list factors;
+	for (unsigned p : odd_primes(n))
+	{
+		push_power(factors, p, legendre(n, p));
+	}
+	return factors.product() << static_cast<int>(legendre(n, 2));
+}
+
+big_integer binomial(unsigned n, unsigned k)
+{
+	if (k > n) return 0;
+	k = std::min(k, n - k);
+
+	// A few factors are cheaper than sieving up to n.
+	if (k < n / 64) return divmod(range_product(n - k + 1, n), factorial(k)).first;
+
+	factor_list factors;
+	for (unsigned p : odd_primes(n))
+	{
+		push_power(factors, p, legendre(n, p) - legendre(k, p) - legendre(n - k, p));
+	}
+	return factors.product() << static_cast<int>(legendre(n, 2) - legendre(k, 2) - legendre(n - k, 2));
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "big_integer.h"
+
+// Products of many factors multiplied as a balanced tree: neighbours first, then their products, and so on, so
+// that both operands of every multiplication have similar sizes and the fast multiplication algorithms apply.
+// Multiplying the factors one by one into a growing result instead takes quadratic time.
+
+// 1 for no factors.
+big_integer product(std::vector<big_integer> const& factors);
+
+template <typename RandomIt>
+big_integer product(RandomIt first, RandomIt last)
+{
+	return product(std::vector<big_integer>(first, last));
+}
+
+// n! and n! / (k! (n - k)!), 0 for k > n; both from the prime factorization of the result, with the powers of
+// two applied as one shift.
+big_integer factorial(unsigned n);
+big_integer binomial(unsigned n, unsigned k);
+
+// p, q and t of a range of terms; see binary_splitting.
+struct series_terms
+{
+	big_integer p;
+	big_integer q;
+	big_integer t;
+};
+
+// The partial sum S = sum over n in [first, last) of a(n) * p(first) * ... * p(n) / (q(first) * ... * q(n)) for
+// a series with members a(n), p(n) and q(n) returning big_integer, as S = t / q. Ranges are split in halves and
+// combined by P = P1 * P2, Q = Q1 * Q2 and T = T1 * Q2 + P1 * T2, which keeps the operands balanced, where
+// summing term by term grows one number at a time.
+template <typename Series>
+series_terms binary_splitting(Series const& series, size_t first, size_t last)
+{
+	if (last <= first) return series_terms{1, 1, 0};
+	if (last - first == 1)
+	{
+		series_terms leaf{series.p(first), series.q(first), 0};
+		leaf.t.set_product(series.a(first), leaf.p);
+		return leaf;
+	}
+
+	size_t middle = first + (last - first) / 2;
+	series_terms left = binary_splitting(series, first, middle);
+	series_terms right = binary_splitting(series, middle, last);
+	left.t.set_product(left.t, right.q);
+	left.t.addmul(left.p, right.t);
+	left.p.set_product(left.p, right.p);
+	left.q.set_product(left.q, right.q);
+	return left;
+}
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "rns_integer.h"
+#include "thread_pool.h"
+
+using limbs::limb;
+using limbs::word_prime;
+
+namespace
+{
+	typedef word_prime::residue residue;
+	typedef word_prime::wide_residue wide_residue;
+
+	// Miller-Rabin with the bases 2, 7 and 61, which decide every odd n < 2^32.
+	bool is_prime(residue n)
+	{
+		word_prime field(n);
+		residue d = n - 1;
+		int s = 0;
+		for (; d % 2 == 0; d /= 2)
+		{
+			++s;
+		}
+
+		for (residue base : {2u, 7u, 61u})
+		{
+			wide_residue x = field.pow(base, d);
+			bool composite = x != 1 && x != n - 1;
+			for (int i = 1; i < s && composite; ++i)
+			{
+				x = x * x % n;
+				composite = x != n - 1;
+			}
+			if (composite) return false;
+		}
+		return true;
+	}
+
+	// f(first, last) over pieces of [first, last), halved across the thread pool while they are longer than
+	// twice parallel_threshold.
+	template <typename F>
+	void for_ranges(size_t first, size_t last, F const& f)
+	{
+		if (last - first < 2 * limbs::parallel_threshold || limbs::thread_count() == 1)
+		{
+			f(first, last);
+			return;
+		}
+
+		size_t middle = first + (last - first) / 2;
+		limbs::run_parallel(true, {
+			[&] { for_ranges(first, middle, f); },
+			[&] { for_ranges(middle, last, f); }});
+	}
+}
+
+rns_basis::rns_basis(size_t bits)
+{
+	// M > 2^(bits + 1) leaves room for both signs.
+	double covered = 0;
+	for (residue p = 0x7fffffff; covered < bits + 2; p -= 2)
+	{
+		if (!is_prime(p)) continue;
+		primes.push_back(word_prime(p));
+		divisors.push_back(limbs::limb_divisor(p));
+		moduli.push_back(p);
+		negated_inverses.push_back(primes.back().negated_inverse);
+		covered += std::log2(p);
+	}
+
+	garner_inverses.resize(primes.size());
+	modulus = 1;
+	for (size_t i = 0; i < primes.size(); ++i)
+	{
+		word_prime const& p = primes[i];
+		wide_residue product = 1;
+		for (size_t j = 0; j < i; ++j)
+		{
+			product = product * (moduli[j] % p.mod) % p.mod;
+		}
+		garner_inverses[i] = p.pow(static_cast<residue>(product), p.mod - 2);
+		modulus *= big_integer(p.mod);
+	}
+	half_modulus = modulus >> 1;
+}
+
+size_t rns_basis::size() const
+{
+	return primes.size();
+}
+
+rns_integer::rns_integer(rns_basis const& basis)
+: basis(&basis), residues(basis.size(), 0)
+{
+}
+
+rns_integer::rns_integer(rns_basis const& basis, big_integer const& value)
+: rns_integer(basis)
+{
+	std::vector<limb> magnitude = value.magnitude();
+	bool negative = value.signum();
+	if (magnitude.empty()) return;
+
+	for_ranges(0, residues.size(), [&](size_t first, size_t last)
+	{
+		std::vector<limb> quotient(magnitude.size());
+		for (size_t i = first; i < last; ++i)
+		{
+			word_prime const& p = basis.primes[i];
+			residue r = static_cast<residue>(limbs::divrem_1(quotient.data(), magnitude.data(), magnitude.size(), basis.divisors[i]));
+			residues[i] = p.to_montgomery(negative && r != 0 ? p.mod - r : r);
+		}
+	});
+}
+
+rns_integer& rns_integer::operator+=(rns_integer const& rhs) &
+{
+	check_basis(rhs);
+	residue* r = residues.data();
+	residue const* b = rhs.residues.data();
+	residue const* mod = basis->moduli.data();
+	for_ranges(0, residues.size(), [=](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			residue s = r[i] + b[i];
+			r[i] = s >= mod[i] ? s - mod[i] : s;
+		}
+	});
+	return *this;
+}
+
+rns_integer& rns_integer::operator-=(rns_integer const& rhs) &
+{
+	check_basis(rhs);
+	residue* r = residues.data();
+	residue const* b = rhs.residues.data();
+	residue const* mod = basis->moduli.data();
+	for_ranges(0, residues.size(), [=](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			residue d = r[i] - b[i] + mod[i];
+			r[i] = d >= mod[i] ? d - mod[i] : d;
+		}
+	});
+	return *this;
+}
+
+rns_integer& rns_integer::operator*=(rns_integer const& rhs) &
+{
+	check_basis(rhs);
+	residue* r = residues.data();
+	residue const* b = rhs.residues.data();
+	residue const* mod = basis->moduli.data();
+	residue const* negated_inverse = basis->negated_inverses.data();
+	for_ranges(0, residues.size(), [=](size_t first, size_t last)
+	{
+		// word_prime::mul, spelled out over the arrays so that the loop vectorizes.
+		for (size_t i = first; i < last; ++i)
+		{
+			wide_residue t = static_cast<wide_residue>(r[i]) * b[i];
+			residue m = static_cast<residue>(t) * negated_inverse[i];
+			residue u = static_cast<residue>((t + static_cast<wide_residue>(m) * mod[i]) >> 32);
+			r[i] = u >= mod[i] ? u - mod[i] : u;
+		}
+	});
+	return *this;
+}
+
+rns_integer rns_integer::operator-() const
+{
+	rns_integer result(*basis);
+	return result -= *this;
+}
+
+rns_integer::operator big_integer() const
+{
+	// Garner's algorithm: the digits of x = d_0 + p_0 * (d_1 + p_1 * (d_2 + ...)) with 0 <= d_i < p_i,
+	// each from its residue less the value of the digits below it.
+	size_t n = residues.size();
+	std::vector<residue> digits(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		word_prime const& p = basis->primes[i];
+		wide_residue below = 0;
+		for (size_t j = i; j-- > 0;)
+		{
+			below = (below * (basis->moduli[j] % p.mod) + digits[j]) % p.mod;
+		}
+		wide_residue x = p.from_montgomery(residues[i]);
+		digits[i] = static_cast<residue>((x + p.mod - below) % p.mod * basis->garner_inverses[i] % p.mod);
+	}
+
+	std::vector<limb> magnitude(n * 32 / limbs::limb_bits + 2, 0);
+	size_t size = 1;
+	for (size_t i = n; i-- > 0;)
+	{
+		limb digit = digits[i];
+		limb carry = limbs::mul_1(magnitude.data(), magnitude.data(), size, basis->moduli[i]);
+		carry += limbs::add(magnitude.data(), magnitude.data(), size, &digit, 1);
+		if (carry != 0) magnitude[size++] = carry;
+	}
+
+	big_integer result;
+	result.set_magnitude(magnitude.data(), size, false);
+	if (result > basis->half_modulus) result -= basis->modulus;
+	return result;
+}
+
+void rns_integer::check_basis(rns_integer const& other) const
+{
+	if (basis != other.basis) throw std::runtime_error("rns_integers of different bases");
+}
+
+bool operator==(rns_integer const& a, rns_integer const& b)
+{
+	a.check_basis(b);
+	return a.residues == b.residues;
+}
+
+bool operator!=(rns_integer const& a, rns_integer const& b)
+{
+	return !(a == b);
+}
+
+rns_integer operator+(rns_integer a, rns_integer const& b)
+{
+	return a += b;
+}
+
+rns_integer operator-(rns_integer a, rns_integer const& b)
+{
+	return a -= b;
+}
+
+rns_integer operator*(rns_integer a, rns_integer const& b)
+{
+	return a *= b;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+// Primes just below 2^31 whose product M covers numbers of a given size, shared by the rns_integers built on it.
+struct rns_basis
+{
+	// Enough primes for every |x| < 2^bits.
+	explicit rns_basis(size_t bits);
+
+	size_t size() const;
+
+private:
+	friend struct rns_integer;
+
+	typedef limbs::word_prime::residue residue;
+
+	std::vector<limbs::word_prime> primes;
+	std::vector<limbs::limb_divisor> divisors;
+	// The moduli and Montgomery constants again, side by side for the loops over all residues.
+	std::vector<residue> moduli;
+	std::vector<residue> negated_inverses;
+	// (p_0 * ... * p_i-1)^-1 mod p_i, for Garner's algorithm.
+	std::vector<residue> garner_inverses;
+	big_integer modulus;
+	big_integer half_modulus;
+};
+
+// A number held as its residues modulo the primes of a basis, in Montgomery form. Addition, subtraction and
+// multiplication work on every residue independently, without carries, so the loops vectorize and large bases
+// split across the thread pool. Results must stay within the range of the basis: they are only known modulo M,
+// and conversion back to big_integer, by the Chinese remainder theorem, picks the one in (-M/2, M/2].
+// That conversion is the expensive step, meant to happen once at the end of a long computation.
+// Operands must share their basis, which has to outlive them.
+struct rns_integer
+{
+	// Zero.
+	explicit rns_integer(rns_basis const& basis);
+	rns_integer(rns_basis const& basis, big_integer const& value);
+
+	rns_integer& operator+=(rns_integer const& rhs) &;
+	rns_integer& operator-=(rns_integer const& rhs) &;
+	rns_integer& operator*=(rns_integer const& rhs) &;
+
+	rns_integer operator-() const;
+
+	explicit operator big_integer() const;
+
+	friend bool operator==(rns_integer const& a, rns_integer const& b);
+	friend bool operator!=(rns_integer const& a, rns_integer const& b);
+
+private:
+	typedef limbs::word_prime::residue residue;
+
+	void check_basis(rns_integer const& other) const;
+
+	rns_basis const* basis;
+	std::vector<residue> residues;
+};
+
+rns_integer operator+(rns_integer a, rns_integer const& b);
+rns_integer operator-(rns_integer a, rns_integer const& b);
+rns_integer operator*(rns_integer a, rns_integer const& b);
+
+bool operator==(rns_integer const& a, rns_integer const& b);
+bool operator!=(rns_integer const& a, rns_integer const& b);
@@ -0,0 +1,312 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+// Vector of trivially copyable elements that keeps up to N of them inline
+// and only allocates once it grows beyond that.
+template <typename T, size_t N>
+struct small_vector
+{
+	small_vector();
+	small_vector(small_vector const& other);
+	small_vector(small_vector&& other) noexcept;
+	~small_vector();
+
+	small_vector& operator=(small_vector const& rhs);
+	small_vector& operator=(small_vector&& rhs) noexcept;
+
+	T& operator[](size_t pos);
+	T const& operator[](size_t pos) const;
+
+	T& front();
+	T const& front() const;
+	T& back();
+	T const& back() const;
+
+	typedef T * iterator;
+	typedef T const * const_iterator;
+
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+	iterator end();
+	const_iterator end() const;
+	const_iterator cend() const;
+
+	std::reverse_iterator<const_iterator> crbegin() const;
+	std::reverse_iterator<const_iterator> crend() const;
+
+	bool empty() const;
+	size_t size() const;
+	size_t capacity() const;
+	bool is_inline() const;
+
+	void reserve(size_t capacity);
+	void resize(size_t size, T const& value = T());
+	void push_back(T const& value);
+	void pop_back();
+	void clear();
+
+	iterator insert(const_iterator pos, size_t count, T const& value);
+	iterator erase(const_iterator first, const_iterator last);
+
+private:
+	T * data_;
+	size_t size_;
+	size_t capacity_;
+	T inline_[N];
+
+	void release();
+};
+
+template <typename T, size_t N>
+small_vector<T, N>::small_vector()
+	: data_(inline_), size_(0), capacity_(N)
+{
+}
+
+template <typename T, size_t N>
+small_vector<T, N>::small_vector(small_vector const& other)
+	: small_vector()
+{
+	*this = other;
+}
+
+template <typename T, size_t N>
+small_vector<T, N>::small_vector(small_vector&& other) noexcept
+	: small_vector()
+{
+	*this = std::move(other);
+}
+
+template <typename T, size_t N>
+small_vector<T, N>::~small_vector()
+{
+	release();
+}
+
+template <typename T, size_t N>
+small_vector<T, N>& small_vector<T, N>::operator=(small_vector const& rhs)
+{
+	if (this == &rhs) return *this;
+
+	size_ = 0;
+	reserve(rhs.size_);
+	std::copy(rhs.data_, rhs.data_ + rhs.size_, data_);
+	size_ = rhs.size_;
+
+	return *this;
+}
+
+template <typename T, size_t N>
+small_vector<T, N>& small_vector<T, N>::operator=(small_vector&& rhs) noexcept
+{
+	if (this == &rhs) return *this;
+	if (rhs.is_inline()) return *this = static_cast<small_vector const&>(rhs);
+
+	// Steal the heap buffer.
+	release();
+	data_ = rhs.data_;
+	size_ = rhs.size_;
+	capacity_ = rhs.capacity_;
+	rhs.data_ = rhs.inline_;
+	rhs.size_ = 0;
+	rhs.capacity_ = N;
+
+	return *this;
+}
+
+template <typename T, size_t N>
+T& small_vector<T, N>::operator[](size_t pos)
+{
+	return data_[pos];
+}
+
+template <typename T, size_t N>
+T const& small_vector<T, N>::operator[](size_t pos) const
+{
+	return data_[pos];
+}
+
+template <typename T, size_t N>
+T& small_vector<T, N>::front()
+{
+	return data_[0];
+}
+
+template <typename T, size_t N>
+T const& small_vector<T, N>::front() const
+{
+	return data_[0];
+}
+
+template <typename T, size_t N>
+T& small_vector<T, N>::back()
+{
+	return data_[size_ - 1];
+}
+
+template <typename T, size_t N>
+T const& small_vector<T, N>::back() const
+{
+	return data_[size_ - 1];
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::begin()
+{
+	return data_;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::const_iterator small_vector<T, N>::begin() const
+{
+	return data_;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::const_iterator small_vector<T, N>::cbegin() const
+{
+	return data_;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::end()
+{
+	return data_ + size_;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::const_iterator small_vector<T, N>::end() const
+{
+	return data_ + size_;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::const_iterator small_vector<T, N>::cend() const
+{
+	return data_ + size_;
+}
+
+template <typename T, size_t N>
+std::reverse_iterator<T const*> small_vector<T, N>::crbegin() const
+{
+	return std::reverse_iterator<const_iterator>(cend());
+}
+
+template <typename T, size_t N>
+std::reverse_iterator<T const*> small_vector<T, N>::crend() const
+{
+	return std::reverse_iterator<const_iterator>(cbegin());
+}
+
+template <typename T, size_t N>
+bool small_vector<T, N>::empty() const
+{
+	return size_ == 0;
+}
+
+template <typename T, size_t N>
+size_t small_vector<T, N>::size() const
+{
+	return size_;
+}
+
+template <typename T, size_t N>
+size_t small_vector<T, N>::capacity() const
+{
+	return capacity_;
+}
+
+template <typename T, size_t N>
+bool small_vector<T, N>::is_inline() const
+{
+	return data_ == inline_;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::reserve(size_t capacity)
+{
+	if (capacity <= capacity_) return;
+
+	capacity = std::max(capacity, 2 * capacity_);
+	T * new_data = new T[capacity];
+	std::copy(data_, data_ + size_, new_data);
+	release();
+	data_ = new_data;
+	capacity_ = capacity;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::resize(size_t size, T const& value)
+{
+	reserve(size);
+	if (size > size_) std::fill(data_ + size_, data_ + size, value);
+	size_ = size;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::push_back(T const& value)
+{
+	if (size_ == capacity_) reserve(size_ + 1);
+	data_[size_++] = value;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::pop_back()
+{
+	if (empty()) throw std::out_of_range("Empty vector");
+	--size_;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::clear()
+{
+	size_ = 0;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::insert(const_iterator pos, size_t count, T const& value)
+{
+	size_t index = pos - data_;
+	reserve(size_ + count);
+	std::copy_backward(data_ + index, data_ + size_, data_ + size_ + count);
+	std::fill(data_ + index, data_ + index + count, value);
+	size_ += count;
+
+	return data_ + index;
+}
+
+template <typename T, size_t N>
+typename small_vector<T, N>::iterator small_vector<T, N>::erase(const_iterator first, const_iterator last)
+{
+	size_t index = first - data_;
+	size_t count = last - first;
+	std::copy(data_ + index + count, data_ + size_, data_ + index);
+	size_ -= count;
+
+	return data_ + index;
+}
+
+template <typename T, size_t N>
+void small_vector<T, N>::release()
+{
+	if (!is_inline()) delete[] data_;
+	data_ = inline_;
+	capacity_ = N;
+}
+
+template <typename T, size_t N>
+bool operator==(small_vector<T, N> const& lhs, small_vector<T, N> const& rhs)
+{
+	return lhs.size() == rhs.size() && std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+template <typename T, size_t N>
+bool operator!=(small_vector<T, N> const& lhs, small_vector<T, N> const& rhs)
+{
+	return !(lhs == rhs);
+}
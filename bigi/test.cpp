@@ -0,0 +1,1013 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "big_accumulator.h"
+#include "big_divisor.h"
+#include "big_expression.h"
+#include "big_integer.h"
+#include "big_integer_array.h"
+#include "big_integer_view.h"
+#include "fixed_integer.h"
+#include "limb_backend.h"
+#include "limb_kernels.h"
+#include "montgomery.h"
+#include "product_tree.h"
+#include "rns_integer.h"
+#include "small_vector.h"
+
+// Heap allocations so far, for the checks of functions that promise to make none.
+std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+// GCC takes the free() of memory from new for a mismatch once the replacements are inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+#pragma GCC diagnostic pop
+
+// Checks the library against simple references: the thresholds are lowered so that small operands already take
+// the fast algorithms, and every result is compared with a plain implementation or verified by an identity.
+// Build it once per limb width (see makefile); a non-zero exit status means a check failed.
+namespace
+{
+	using limbs::limb;
+
+	std::mt19937_64 random(1);
+	int failures = 0;
+
+	void check(bool ok, char const* what)
+	{
+		if (ok) return;
+		if (++failures <= 20) std::printf("FAILED: %s\n", what);
+	}
+
+	std::vector<limb> random_limbs(size_t n)
+	{
+		std::vector<limb> result(n);
+		for (auto& x : result)
+		{
+			// Runs of all-zero and all-one limbs reach the carry corner cases.
+			switch (random() % 8)
+			{
+			case 0:
+				x = 0;
+				break;
+			case 1:
+				x = ~limb(0);
+				break;
+			default:
+				x = static_cast<limb>(random());
+			}
+		}
+		return result;
+	}
+
+	big_integer random_number(size_t max_bits)
+	{
+		size_t bits = random() % (max_bits + 1);
+		big_integer result = 0;
+		for (size_t i = 0; i < bits; i += 32)
+		{
+			result <<= 32;
+			result += static_cast<unsigned>(random());
+		}
+		if (random() % 8 == 0) result = (big_integer(1) << static_cast<int>(bits)) - static_cast<int>(random() % 2);
+		return random() % 2 ? -result : result;
+	}
+
+	big_integer random_nonzero(size_t max_bits)
+	{
+		big_integer result = random_number(max_bits);
+		return result == 0 ? big_integer(7) : result;
+	}
+
+	big_integer abs(big_integer const& a)
+	{
+		return a < 0 ? -a : a;
+	}
+
+	// r = a + b and r = a - b over n limbs, one limb and one carry at a time.
+	limb reference_add(limb* r, limb const* a, limb const* b, size_t n)
+	{
+		limb carry = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			limb sum = a[i] + b[i];
+			limb next = sum < a[i];
+			r[i] = sum + carry;
+			carry = next | (r[i] < sum);
+		}
+		return carry;
+	}
+
+	limb reference_sub(limb* r, limb const* a, limb const* b, size_t n)
+	{
+		limb borrow = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			limb difference = a[i] - b[i];
+			limb next = a[i] < b[i];
+			r[i] = difference - borrow;
+			borrow = next | (difference < borrow);
+		}
+		return borrow;
+	}
+
+	// The operators on numbers small enough for long long to compute the same results.
+	void check_native(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			long long a = static_cast<int>(random()), b = static_cast<int>(random()) >> (random() % 31);
+			if (b == 0) b = 1;
+			big_integer x = a, y = b;
+			check(to_string(x + y) == std::to_string(a + b) && to_string(x - y) == std::to_string(a - b), "+ and -");
+			check(to_string(x * y) == std::to_string(a * b), "*");
+			check(to_string(x / y) == std::to_string(a / b) && to_string(x % y) == std::to_string(a % b), "/ and %");
+
+			int shift = random() % 31;
+			check(to_string(x << shift) == std::to_string(a * (1LL << shift)), "<<");
+			check(to_string(x >> shift) == std::to_string(a >> shift), ">>");
+			check(to_string(x & y) == std::to_string(a & b) && to_string(x | y) == std::to_string(a | b), "& and |");
+			check(to_string(x ^ y) == std::to_string(a ^ b) && to_string(~x) == std::to_string(~a), "^ and ~");
+			check((x < y) == (a < b) && (x == y) == (a == b) && (x >= y) == (a >= b), "comparison");
+			check(big_integer(std::to_string(a)) == x, "string constructor");
+		}
+	}
+
+	void check_multiplication(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			size_t an = 1 + random() % 300;
+			size_t bn = 1 + random() % an;
+			std::vector<limb> a = random_limbs(an), b = random_limbs(bn);
+			std::vector<limb> expected(an + bn), r(an + bn);
+			limbs::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+
+			limbs::mul(r.data(), a.data(), an, b.data(), bn);
+			check(r == expected, "mul");
+			if (limbs::ntt_fits(an, bn))
+			{
+				limbs::mul_ntt(r.data(), a.data(), an, b.data(), bn);
+				check(r == expected, "mul_ntt");
+			}
+
+			std::vector<limb> square(2 * an), square_expected(2 * an);
+			limbs::sqr(square.data(), a.data(), an);
+			limbs::mul_basecase(square_expected.data(), a.data(), an, a.data(), an);
+			check(square == square_expected, "sqr");
+
+			// The single-limb products against mul_basecase and the carry chains.
+			limb w = b[0];
+			std::vector<limb> product(an + 1), accumulated = random_limbs(an);
+			limbs::mul_basecase(product.data(), a.data(), an, &w, 1);
+			check(limbs::mul_1(r.data(), a.data(), an, w) == product[an] && std::equal(r.begin(), r.begin() + an, product.begin()), "mul_1");
+
+			std::vector<limb> sum(an + 1, 0), difference(an + 1, 0);
+			limb carry = reference_add(sum.data(), accumulated.data(), product.data(), an);
+			limb borrow = reference_sub(difference.data(), accumulated.data(), product.data(), an);
+			std::vector<limb> t = accumulated;
+			check(limbs::addmul_1(t.data(), a.data(), an, w) == product[an] + carry && std::equal(t.begin(), t.end(), sum.begin()), "addmul_1");
+			t = accumulated;
+			check(limbs::submul_1(t.data(), a.data(), an, w) == product[an] + borrow && std::equal(t.begin(), t.end(), difference.begin()), "submul_1");
+		}
+	}
+
+	void check_division(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			size_t bn = 2 + random() % 150;
+			size_t an = bn + random() % 200;
+			std::vector<limb> a = random_limbs(an), b = random_limbs(bn);
+			b[bn - 1] |= limb(1) << (random() % limbs::limb_bits);
+
+			std::vector<limb> q(an - bn + 1), r(bn), knuth_q(an - bn + 1), knuth_r(bn);
+			limbs::divrem(q.data(), r.data(), a.data(), an, b.data(), bn);
+			limbs::divrem_knuth(knuth_q.data(), knuth_r.data(), a.data(), an, b.data(), bn);
+			check(q == knuth_q && r == knuth_r, "divrem against Knuth");
+
+			// q * b + r == a with r < b.
+			std::vector<limb> back(an + 1, 0);
+			limbs::mul_basecase(back.data(), q.data(), q.size(), b.data(), bn);
+			limbs::add(back.data(), back.data(), back.size(), r.data(), bn);
+			check(std::equal(a.begin(), a.end(), back.begin()) && back[an] == 0, "divrem identity");
+			check(limbs::compare(r.data(), bn, b.data(), bn) < 0, "divrem remainder");
+		}
+
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(6000), b = random_nonzero(3000);
+			auto qr = divmod(a, b);
+			check(qr.first * b + qr.second == a && abs(qr.second) < abs(b), "divmod");
+			check(qr.second == 0 || (qr.second < 0) == (a < 0), "divmod remainder sign");
+			check(qr.first == a / b && qr.second == a % b, "divmod against / and %");
+
+			big_divisor d(b);
+			auto prepared = d.divmod(a);
+			check(prepared == qr && d.div(a) == qr.first && d.mod(a) == qr.second, "big_divisor");
+			big_integer word = random_nonzero(limbs::limb_bits);
+			check(big_divisor(word).divmod(a) == divmod(a, word), "big_divisor by a single limb");
+		}
+	}
+
+	void check_decimal(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			size_t n = random() % 200;
+			std::vector<limb> a = random_limbs(n);
+			std::string fast = limbs::to_decimal(a.data(), n);
+
+			// The same without splitting, chunk by chunk.
+			size_t threshold = limbs::radix_threshold;
+			limbs::radix_threshold = std::numeric_limits<size_t>::max();
+			std::string simple = limbs::to_decimal(a.data(), n);
+			std::vector<limb> simple_parsed = limbs::from_decimal(simple.data(), simple.size());
+			limbs::radix_threshold = threshold;
+			check(fast == simple, "to_decimal against the simple conversion");
+
+			std::vector<limb> scratch = a;
+			std::vector<char> digits(limbs::decimal_digits_bound(n));
+			char* end = digits.data() + digits.size();
+			char* begin = limbs::to_decimal_backward(scratch.data(), n, end);
+			check(fast == std::string(begin, end), "to_decimal against to_decimal_backward");
+
+			std::vector<limb> parsed = limbs::from_decimal(fast.data(), fast.size());
+			check(limbs::compare(parsed.data(), parsed.size(), a.data(), n) == 0, "from_decimal");
+			check(parsed == simple_parsed, "from_decimal against the simple conversion");
+		}
+
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(8000);
+			std::string text = to_string(a);
+			check(big_integer(text) == a, "to_string round trip");
+
+			for (int base : {10, 2, 4, 8, 16, 32})
+			{
+				std::vector<char> buffer(text.size() * 4 + 2);
+				auto written = to_chars(buffer.data(), buffer.data() + buffer.size(), a, base);
+				size_t length = written.ptr - buffer.data();
+				check(to_chars(buffer.data(), buffer.data() + length, a, base).ptr == written.ptr, "to_chars into an exact buffer");
+				check(to_chars(buffer.data(), buffer.data() + length - 1, a, base).ec == std::errc::value_too_large, "to_chars into a short buffer");
+				check(base != 10 || std::string(buffer.data(), length) == text, "to_chars against to_string");
+
+				big_integer parsed;
+				auto read = from_chars(buffer.data(), buffer.data() + length, parsed, base);
+				check(read.ec == std::errc() && read.ptr == buffer.data() + length && parsed == a, "from_chars");
+			}
+
+			for (auto flag : {std::ios_base::dec, std::ios_base::hex, std::ios_base::oct})
+			{
+				std::stringstream stream;
+				stream.setf(flag, std::ios_base::basefield);
+				stream << a << ' ' << -a;
+				big_integer x, y;
+				stream >> x >> y;
+				check(x == a && y == -a, "stream round trip");
+			}
+		}
+	}
+
+	void check_allocations(size_t rounds)
+	{
+		char buffer[4200];
+		big_integer parsed = big_integer(1) << 1000;
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(4096);
+			big_integer short_value = random_number(224);
+			for (int base : {10, 2, 8, 16, 32})
+			{
+				size_t before = allocations;
+				auto written = to_chars(buffer, buffer + sizeof(buffer), a, base);
+				auto too_short = to_chars(buffer, buffer + 10, a, base);
+				check(allocations == before && written.ec == std::errc(), "to_chars without allocating");
+				bool fits = written.ptr - buffer <= 10;
+				check(too_short.ec == (fits ? std::errc() : std::errc::value_too_large), "to_chars into a short buffer");
+
+				written = to_chars(buffer, buffer + sizeof(buffer), short_value, base);
+				before = allocations;
+				from_chars(buffer, written.ptr, parsed, base);
+				big_integer fresh;
+				from_chars(buffer, written.ptr, fresh, base);
+				check(allocations == before, "from_chars without allocating");
+				check(parsed == short_value && fresh == short_value, "from_chars into inline storage");
+			}
+		}
+
+		// The longest inputs that still fit: 76 decimal nines and 255 one bits.
+		auto longest = { std::make_pair("-" + std::string(76, '9'), 10), std::make_pair("-7" + std::string(63, 'f'), 16) };
+		for (auto const& input : longest)
+		{
+			std::string const& text = input.first;
+			size_t before = allocations;
+			big_integer fresh;
+			from_chars(text.data(), text.data() + text.size(), fresh, input.second);
+			check(allocations == before, "from_chars of the longest inline input without allocating");
+			auto written = to_chars(buffer, buffer + sizeof(buffer), fresh, input.second);
+			check(std::string(buffer, written.ptr) == text, "from_chars of the longest inline input");
+		}
+	}
+
+	// Has to run before any other decimal conversion: the powers of the decimal base are then computed while
+	// conversions running on the pool need them, and their squarings go through the pool as well.
+	void check_cold_decimal()
+	{
+		limbs::set_thread_count(8);
+		limbs::parallel_threshold = 8;
+		std::string text(200000, '0');
+		for (auto& c : text)
+		{
+			c = static_cast<char>('0' + random() % 10);
+		}
+		text[0] = '7';
+		big_integer a(text);
+		check(to_string(a) == text, "threaded decimal conversion with no cached powers");
+		limbs::set_thread_count(1);
+		limbs::parallel_threshold = 1000;
+	}
+
+	// small_vector against std::vector through random edits that move it between inline and heap storage.
+	void check_storage(size_t rounds)
+	{
+		small_vector<int, 4> v;
+		std::vector<int> expected;
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			int x = static_cast<int>(random() % 1000);
+			size_t at = expected.empty() ? 0 : random() % expected.size();
+			switch (random() % 8)
+			{
+			case 0:
+			case 1:
+				v.push_back(x);
+				expected.push_back(x);
+				break;
+			case 2:
+				if (!expected.empty())
+				{
+					v.pop_back();
+					expected.pop_back();
+				}
+				break;
+			case 3:
+				v.resize(at + 3, x);
+				expected.resize(at + 3, x);
+				break;
+			case 4:
+				v.insert(v.cbegin() + at, 2, x);
+				expected.insert(expected.cbegin() + at, 2, x);
+				break;
+			case 5:
+				v.erase(v.cbegin() + at, v.cbegin() + std::min(at + 2, expected.size()));
+				expected.erase(expected.cbegin() + at, expected.cbegin() + std::min(at + 2, expected.size()));
+				break;
+			case 6:
+			{
+				small_vector<int, 4> copy(v);
+				v = std::move(copy);
+				break;
+			}
+			default:
+				if (random() % 4 == 0)
+				{
+					v.clear();
+					expected.clear();
+				}
+				v = small_vector<int, 4>(v);
+			}
+			check(v.size() == expected.size() && std::equal(expected.begin(), expected.end(), v.cbegin()), "small_vector");
+			small_vector<int, 4> copy = v;
+			check(copy == v && copy.is_inline() == (v.size() <= 4), "small_vector copy");
+		}
+
+		// Numbers around the inline capacity, copied and moved between inline and heap storage.
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(400), b = random_number(400);
+			big_integer sum = a + b, c = a;
+			c += b;
+			check(c == sum, "+= across the inline capacity");
+			c -= b;
+			big_integer moved = std::move(c);
+			check(moved == a, "-= across the inline capacity");
+			c = b;
+			c = std::move(moved);
+			moved = c;
+			check(c == a && moved == a, "assignment across the inline capacity");
+		}
+	}
+
+	// Every operator with temporaries on either side, against the same with named operands.
+	void check_moves(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(1000), b = random_nonzero(1000);
+			auto left = [&] { return big_integer(a); };
+			auto right = [&] { return big_integer(b); };
+			check(left() + b == a + b && a + right() == a + b, "+ with temporaries");
+			check(left() - b == a - b, "- with temporaries");
+			check(left() * b == a * b && a * right() == a * b, "* with temporaries");
+			check(left() / b == a / b && left() % b == a % b, "/ and % with temporaries");
+			check((left() & b) == (a & b) && (a & right()) == (a & b), "& with temporaries");
+			check((left() | b) == (a | b) && (a | right()) == (a | b), "| with temporaries");
+			check((left() ^ b) == (a ^ b) && (a ^ right()) == (a ^ b), "^ with temporaries");
+			check((left() << 37) == (a << 37) && (left() >> 37) == (a >> 37), "shifts with temporaries");
+			check(-left() == -a && ~left() == ~a && +left() == a, "unary operators with temporaries");
+
+			big_integer moved = a;
+			big_integer target = std::move(moved);
+			moved = b;
+			check(target == a && moved == b, "assignment to a moved-from number");
+		}
+	}
+
+	void check_addition(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			size_t an = 1 + random() % 40;
+			size_t bn = 1 + random() % an;
+			std::vector<limb> a = random_limbs(an), b = random_limbs(bn);
+			limb extension = b[bn - 1] >> (limbs::limb_bits - 1) ? ~limb(0) : 0;
+			std::vector<limb> wide_b(b), zero_b(b);
+			wide_b.resize(an, extension);
+			zero_b.resize(an, 0);
+
+			std::vector<limb> r(an), expected(an);
+			limb carry = reference_add(expected.data(), a.data(), zero_b.data(), an);
+			check(limbs::add(r.data(), a.data(), an, b.data(), bn) == carry && r == expected, "add");
+			carry = reference_sub(expected.data(), a.data(), zero_b.data(), an);
+			if (carry == 0)
+			{
+				check(limbs::sub(r.data(), a.data(), an, b.data(), bn) == 0 && r == expected, "sub");
+			}
+
+			reference_add(expected.data(), a.data(), wide_b.data(), an);
+			r = a;
+			limbs::add_signed(r.data(), r.data(), an, b.data(), bn);
+			check(r == expected, "add_signed in place");
+			reference_sub(expected.data(), a.data(), wide_b.data(), an);
+			limbs::sub_signed(r.data(), a.data(), an, b.data(), bn);
+			check(r == expected, "sub_signed");
+
+			std::vector<limb> zero(an, 0);
+			reference_sub(expected.data(), zero.data(), a.data(), an);
+			limbs::negate(r.data(), a.data(), an);
+			check(r == expected, "negate");
+		}
+
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(2000), b = random_number(2000);
+			big_integer r = a;
+			r += b;
+			check(r == a - -b && r - b == a, "+=");
+			r -= a;
+			check(r == b, "-=");
+			r = a;
+			r += r;
+			check(r == a << 1, "+= itself");
+			r -= r;
+			check(r == 0, "-= itself");
+		}
+	}
+
+	void check_bitwise(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			// Lengths around the vector widths, to reach the scalar tails.
+			size_t n = random() % 40;
+			std::vector<limb> a = random_limbs(n), b = random_limbs(n);
+			std::vector<limb> r(n), and_expected(n), or_expected(n), xor_expected(n), map_expected(n);
+			limb zeros = static_cast<limb>(random()), ones = static_cast<limb>(random());
+			for (size_t i = 0; i < n; ++i)
+			{
+				and_expected[i] = a[i] & b[i];
+				or_expected[i] = a[i] | b[i];
+				xor_expected[i] = a[i] ^ b[i];
+				map_expected[i] = (a[i] & ones) | (~a[i] & zeros);
+			}
+			limbs::and_n(r.data(), a.data(), b.data(), n);
+			check(r == and_expected, "and_n");
+			limbs::or_n(r.data(), a.data(), b.data(), n);
+			check(r == or_expected, "or_n");
+			r = a;
+			limbs::xor_n(r.data(), r.data(), b.data(), n);
+			check(r == xor_expected, "xor_n in place");
+			limbs::bitwise_map(r.data(), a.data(), n, zeros, ones);
+			check(r == map_expected, "bitwise_map");
+
+			int shift = random() % limbs::limb_bits;
+			std::vector<limb> left(n), right(n);
+			limb left_out = 0, right_out = 0;
+			for (size_t i = 0; i < n && shift != 0; ++i)
+			{
+				left[i] = a[i] << shift | (i > 0 ? a[i - 1] >> (limbs::limb_bits - shift) : 0);
+				right[i] = a[i] >> shift | (i + 1 < n ? a[i + 1] << (limbs::limb_bits - shift) : 0);
+				left_out = a[i] >> (limbs::limb_bits - shift);
+				right_out = i == 0 ? a[0] << (limbs::limb_bits - shift) : right_out;
+			}
+			if (shift == 0) left = right = a;
+			check(limbs::lshift(r.data(), a.data(), n, shift) == left_out && r == left, "lshift");
+			check(limbs::rshift(r.data(), a.data(), n, shift) == right_out && r == right, "rshift");
+		}
+
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(2000), b = random_number(2000);
+			check((a & b) + (a | b) == a + b && (a ^ b) == (a | b) - (a & b), "&, | and ^");
+			check(~a == -a - 1 && (a & ~a) == 0 && (a | ~a) == -1, "~");
+
+			int shift = random() % 300;
+			big_integer power = 1;
+			for (int i = 0; i < shift; ++i)
+			{
+				power *= 2;
+			}
+			big_integer low = (a % power + power) % power;
+			check((a << shift) == a * power && (a >> shift) == (a - low) / power, "<< and >>");
+			check((a & (power - 1)) == low, "& by a mask");
+		}
+	}
+
+	big_integer reference_powmod(big_integer base, big_integer exp, big_integer const& mod)
+	{
+		big_integer m = abs(mod), result = 1 % m;
+		base %= m;
+		if (base < 0) base += m;
+		for (; exp != 0; exp >>= 1)
+		{
+			if ((exp & 1) != 0) result = result * base % m;
+			base = base * base % m;
+		}
+		return result;
+	}
+
+	void check_modular(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer mod = random_nonzero(1500);
+			big_integer base = random_number(2000), exp = abs(random_number(300));
+			check(powmod(base, exp, mod) == reference_powmod(base, exp, mod), "powmod");
+
+			big_integer odd = abs(mod) | 1;
+			if (odd == 1) continue;
+			montgomery_context context(odd);
+			big_integer a = abs(random_number(1500)) % odd, b = abs(random_number(1500)) % odd;
+			big_integer ma = context.to_montgomery(a), mb = context.to_montgomery(b);
+			check(context.from_montgomery(context.mul(ma, mb)) == a * b % odd, "montgomery mul");
+			check(context.from_montgomery(context.sqr(ma)) == a * a % odd, "montgomery sqr");
+			check(context.from_montgomery(context.pow(ma, exp)) == reference_powmod(a, exp, odd), "montgomery pow");
+		}
+	}
+
+	big_integer euclid(big_integer a, big_integer b)
+	{
+		a = abs(a);
+		b = abs(b);
+		while (b != 0)
+		{
+			a %= b;
+			std::swap(a, b);
+		}
+		return a;
+	}
+
+	void check_number_theory(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(3000), b = random_number(3000);
+			big_integer common = random_number(500);
+			a *= common;
+			b *= common;
+			big_integer g = gcd(a, b);
+			check(g == euclid(a, b), "gcd");
+			check(g == 0 ? lcm(a, b) == 0 : lcm(a, b) == abs(a / g * b), "lcm");
+
+			big_integer m = abs(random_nonzero(2000)) + 2;
+			big_integer x = abs(random_number(2000)) % m;
+			if (euclid(x, m) == 1)
+			{
+				check(mod_inverse(x, m) * x % m == 1, "mod_inverse");
+			}
+
+			big_integer s = abs(random_number(4000));
+			big_integer root = isqrt(s);
+			check(root * root <= s && (root + 1) * (root + 1) > s, "isqrt");
+
+			unsigned exponent = random() % 40;
+			big_integer base = random_number(200), power = 1;
+			for (unsigned i = 0; i < exponent; ++i)
+			{
+				power *= base;
+			}
+			check(pow(base, exponent) == power, "pow");
+		}
+	}
+
+	void check_accumulator(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_accumulator accumulator;
+			big_integer sum = 0;
+			for (size_t count = random() % 60; count > 0; --count)
+			{
+				big_integer x = random_number(600);
+				if (random() % 3 == 0)
+				{
+					accumulator -= x;
+					sum -= x;
+				}
+				else
+				{
+					accumulator += x;
+					sum += x;
+				}
+			}
+			long long native = static_cast<long long>(random());
+			accumulator += native;
+			sum += native;
+			check(accumulator.value() == sum, "big_accumulator");
+		}
+	}
+
+	// big_integer_array against a std::vector of the same numbers through batches that widen and narrow it.
+	void check_array(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			std::vector<big_integer> values(random() % 60);
+			for (auto& x : values)
+			{
+				x = random_number(600);
+			}
+			big_integer_array array(values);
+
+			for (int step = 0; step < 8; ++step)
+			{
+				big_integer c = random_number(700);
+				limb factor = random() % 4 == 0 ? static_cast<limb>(random()) : random() % 1000;
+				big_integer wide_factor = 0;
+				for (int shift = limbs::limb_bits - 16; shift >= 0; shift -= 16)
+				{
+					wide_factor = (wide_factor << 16) + static_cast<int>((factor >> shift) & 0xffff);
+				}
+				array.add(c);
+				array.mul(factor);
+				for (auto& x : values)
+				{
+					x = (x + c) * wide_factor;
+				}
+				if (!values.empty() && random() % 2 == 0)
+				{
+					size_t index = random() % values.size();
+					values[index] = random_number(1500);
+					array.set(index, values[index]);
+				}
+				if (random() % 2 == 0)
+				{
+					values.push_back(random_number(900));
+					array.push_back(values.back());
+				}
+			}
+
+			std::vector<big_integer> stored = array.to_vector();
+			check(stored == values && array.size() == values.size(), "big_integer_array add, mul, set and push_back");
+			big_integer sum = 0;
+			for (auto const& x : values)
+			{
+				sum += x;
+			}
+			check(array.sum() == sum, "big_integer_array sum");
+			big_integer c = values.empty() ? big_integer(0) : values[random() % values.size()];
+			std::vector<int> order = array.compare(c);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				big_integer d = values[i] - c;
+				check(order[i] == (d > 0) - (d < 0) && array.get(i) == values[i], "big_integer_array compare and get");
+			}
+		}
+	}
+
+	void check_serialization(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer x = random_number(2000);
+			std::vector<char> record(serialized_size(x));
+			check(record.size() % 8 == 0, "serialized_size");
+			check(serialize(record.data(), record.data() + record.size() - 1, x).ec == std::errc::value_too_large, "serialize into a short buffer");
+			check(serialize(record.data(), record.data() + record.size(), x).ptr == record.data() + record.size(), "serialize");
+			big_integer back;
+			auto read = deserialize(record.data(), record.data() + record.size(), back);
+			check(read.ec == std::errc() && read.ptr == record.data() + record.size() && back == x, "deserialize");
+			check(deserialize(record.data(), record.data() + record.size() - 8, back).ec == std::errc::invalid_argument, "deserialize a cut record");
+
+			std::vector<std::uint64_t> aligned((record.size() + 7) / 8);
+			std::copy(record.begin(), record.end(), reinterpret_cast<char*>(aligned.data()));
+			char const* first = reinterpret_cast<char const*>(aligned.data());
+			big_integer_view view;
+			check(deserialize(first, first + record.size(), view).ec == std::errc() && view.value() == x, "big_integer_view");
+			check(to_string(view) == to_string(x) && view.negative() == (x < 0), "big_integer_view to_string");
+		}
+	}
+
+	// fixed_integer<256> against big_integer results wrapped around to 256 bits.
+	void check_fixed(size_t rounds)
+	{
+		typedef fixed_integer<256> fixed;
+		static_assert((fixed(1) << 255) + (fixed(1) << 255) == fixed(0), "fixed_integer wraps at compile time");
+		static_assert(fixed(-7) / fixed(2) == fixed(-3) && fixed(-7) % fixed(2) == fixed(-1), "fixed_integer division at compile time");
+
+		big_integer modulus = big_integer(1) << 256;
+		auto wrap = [&](big_integer x)
+		{
+			x %= modulus;
+			if (x < 0) x += modulus;
+			return x >= (modulus >> 1) ? x - modulus : x;
+		};
+
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = wrap(random_number(256)), b = wrap(random_nonzero(200));
+			fixed x(a), y(b);
+			check(big_integer(x) == a, "fixed_integer conversion");
+			check(big_integer(x + y) == wrap(a + b), "fixed_integer +");
+			check(big_integer(x - y) == wrap(a - b), "fixed_integer -");
+			check(big_integer(x * y) == wrap(a * b), "fixed_integer *");
+			check(big_integer(x / y) == wrap(a / b) && big_integer(x % y) == a % b, "fixed_integer / and %");
+			int shift = random() % 256;
+			check(big_integer(x << shift) == wrap(a << shift) && big_integer(x >> shift) == (a >> shift), "fixed_integer shifts");
+			check((x < y) == (a < b) && (x == y) == (a == b), "fixed_integer compare");
+		}
+	}
+
+	void check_conversions(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			long long native = static_cast<long long>(random()) >> (random() % 64);
+			big_integer n = native;
+			check(n.fits_in<long long>() && n.to<long long>() == native, "to<long long>");
+			check(n.fits_in<int>() == (native >= -2147483648LL && native <= 2147483647LL), "fits_in<int>");
+			check(n.truncate<unsigned>() == static_cast<unsigned>(native), "truncate<unsigned>");
+			check(n.fits_in<unsigned long long>() == (native >= 0), "fits_in<unsigned long long>");
+			check(big_integer(static_cast<double>(native >> 11)) == (native >> 11), "double conversion");
+			check(n.to<double>() == static_cast<double>(native), "to<double>");
+
+			unsigned long long high = random(), low = random();
+			big_integer wide = (big_integer(high) << 64) + low;
+			check(!wide.fits_in<unsigned long long>() || high == 0, "fits_in<unsigned long long> past 64 bits");
+			check(wide.truncate<unsigned long long>() == low && (wide >> 64).to<unsigned long long>() == high, "truncate past 64 bits");
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 native_wide = static_cast<unsigned __int128>(high) << 64 | low;
+			check(big_integer(native_wide) == wide && wide.to<unsigned __int128>() == native_wide, "unsigned __int128");
+			check(wide.fits_in<__int128>() == (high >> 63 == 0), "fits_in<__int128>");
+#endif
+		}
+	}
+
+	void check_fused(size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(2000), b = random_number(2000), c = random_number(3000);
+			limb w = static_cast<limb>(random());
+			big_integer wide_w = 0;
+			for (int shift = limbs::limb_bits - 16; shift >= 0; shift -= 16)
+			{
+				wide_w = (wide_w << 16) + static_cast<int>((w >> shift) & 0xffff);
+			}
+
+			big_integer r = c;
+			check(r.addmul(a, b) == c + a * b, "addmul");
+			r = c;
+			check(r.submul(a, b) == c - a * b, "submul");
+			r = c;
+			check(r.addmul_word(a, w) == c + a * wide_w, "addmul_word");
+			r = c;
+			check(r.submul_word(a, w) == c - a * wide_w, "submul_word");
+			r = a;
+			check(r.set_product(r, b) == a * b, "set_product aliasing");
+			r = a;
+			check(r.addmul(r, r) == a + a * a, "addmul aliasing");
+
+			r = lazy(a) * b + c;
+			check(r == a * b + c, "lazy product sum");
+			r = lazy(a) * b - lazy(c) * a;
+			check(r == a * b - c * a, "lazy product difference");
+			r = c;
+			r += lazy(a) * b;
+			check(r == c + a * b, "lazy +=");
+		}
+	}
+
+	void check_queries(size_t rounds)
+	{
+		std::unordered_set<big_integer> seen;
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(300), b = random() % 4 == 0 ? a : random_number(300);
+			big_integer d = a - b;
+			check(compare(a, b) == (d > 0) - (d < 0), "compare");
+			check((a < b) == (d < 0) && (a >= b) == (d >= 0), "ordering");
+			check(a != b || std::hash<big_integer>()(a) == std::hash<big_integer>()(b), "hash");
+			seen.insert(a);
+			check(seen.count(big_integer(to_string(a))) == 1, "unordered_set lookup");
+
+			big_integer m = abs(a);
+			size_t bits = 0, ones = 0;
+			for (big_integer t = m; t != 0; t >>= 1)
+			{
+				ones += (t & 1) != 0;
+				++bits;
+			}
+			check(bit_length(a) == bits && popcount(a) == ones, "bit_length and popcount");
+			check(m == 0 || ((m >> static_cast<int>(countr_zero(a))) & 1) == 1, "countr_zero");
+		}
+	}
+
+	void check_rns(size_t rounds)
+	{
+		rns_basis basis(3000);
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(700), b = random_number(700), c = random_number(1400);
+			rns_integer x(basis, a), y(basis, b), z(basis, c);
+			check(big_integer(x * y - z + x) == a * b - c + a, "rns_integer");
+			check(big_integer(-x) == -a && (x == y) == (a == b), "rns_integer negation and equality");
+		}
+	}
+
+	// sum of 1 / n! for e.
+	struct exponential_series
+	{
+		big_integer a(size_t) const
+		{
+			return 1;
+		}
+
+		big_integer p(size_t) const
+		{
+			return 1;
+		}
+
+		big_integer q(size_t n) const
+		{
+			return n == 0 ? 1 : static_cast<unsigned long long>(n);
+		}
+	};
+
+	void check_products()
+	{
+		big_integer expected = 1;
+		for (unsigned n = 0; n < 600; ++n)
+		{
+			if (n > 0) expected *= n;
+			check(factorial(n) == expected, "factorial");
+		}
+		for (unsigned n = 0; n < 300; n += 7)
+		{
+			for (unsigned k = 0; k <= n + 1; k += 3)
+			{
+				big_integer reference = k > n ? big_integer(0) : factorial(n) / (factorial(k) * factorial(n - k));
+				check(binomial(n, k) == reference, "binomial");
+			}
+		}
+		check(binomial(100000, 3) == big_integer(100000) * 99999 * 99998 / 6, "binomial with a small k");
+
+		std::vector<big_integer> factors;
+		big_integer product_expected = 1;
+		for (int i = 0; i < 100; ++i)
+		{
+			factors.push_back(random_number(300));
+			product_expected *= factors.back();
+		}
+		check(product(factors) == product_expected && product(factors.begin(), factors.begin()) == 1, "product");
+
+		// t / q = sum of 1 / n! for n < 200, so q = 199! and t = sum of 199! / n!.
+		series_terms e = binary_splitting(exponential_series(), 0, 200);
+		big_integer t = 0, term = 1;
+		for (unsigned n = 199; n > 0; --n)
+		{
+			t += term;
+			term *= n;
+		}
+		t += term;
+		check(e.q == factorial(199) && e.t == t, "binary_splitting");
+	}
+
+	// The arithmetic through whatever kernels are in use, against the same with the built-in ones.
+	void check_kernels(limbs::kernel_table const& table, size_t rounds)
+	{
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			big_integer a = random_number(6000), b = random_nonzero(3000);
+			int shift = random() % 200;
+			auto compute = [&]
+			{
+				return to_string(a * b + (a << shift) - (b >> shift) + (a & b) + (a | ~b) + (a ^ b) + a / b + a % b + pow(b, 3));
+			};
+			limbs::set_kernels(limbs::kernel::table);
+			std::string expected = compute();
+			limbs::set_kernels(table);
+			check(compute() == expected, table.name);
+		}
+		limbs::set_kernels(limbs::kernel::table);
+	}
+
+	void run_all()
+	{
+		check_native(1000);
+		check_multiplication(200);
+		check_division(150);
+		check_decimal(100);
+		check_allocations(200);
+		check_storage(2000);
+		check_moves(300);
+		check_addition(1000);
+		check_bitwise(1000);
+		check_modular(60);
+		check_number_theory(100);
+		check_accumulator(100);
+		check_array(40);
+		check_serialization(300);
+		check_fixed(300);
+		check_conversions(1000);
+		check_fused(200);
+		check_queries(500);
+		check_rns(100);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// Small enough for every algorithm to run on operands of a few hundred limbs.
+	limbs::karatsuba_threshold = 4;
+	limbs::toom3_threshold = 12;
+	limbs::ntt_threshold = 24;
+	limbs::burnikel_ziegler_threshold = 4;
+	limbs::radix_threshold = 2;
+
+	std::printf("limb bits: %d\n", limbs::limb_bits);
+	check_cold_decimal();
+	run_all();
+	check_products();
+
+	// The parallel paths, with small pieces handed to the thread pool.
+	limbs::set_thread_count(4);
+	limbs::parallel_threshold = 8;
+	check_multiplication(100);
+	check_division(50);
+	check_decimal(50);
+	check_rns(50);
+	limbs::set_thread_count(1);
+	limbs::parallel_threshold = 1000;
+
+	// Backends from 'make backends', in the directory given or the current one.
+	std::string name = limbs::load_kernels(argc > 1 ? argv[1] : ".");
+	if (name != limbs::kernel::table.name)
+	{
+		std::printf("kernels: %s\n", name.c_str());
+		limbs::kernel_table const& loaded = limbs::kernels();
+		check_kernels(loaded, 200);
+		limbs::set_kernels(loaded);
+		run_all();
+	}
+
+	std::printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
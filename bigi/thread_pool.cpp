@@ -0,0 +1,176 @@
+#include "limb_kernels.h"
+#include "thread_pool.h"
+
+namespace limbs
+{
+	size_t parallel_threshold = 1000;
+
+	namespace
+	{
+		thread_local thread_pool const* current_pool = nullptr;
+		thread_local size_t current_queue = 0;
+
+		std::mutex shared_pool_mutex;
+		std::shared_ptr<thread_pool> shared_pool;
+	}
+
+	thread_pool::thread_pool(size_t workers)
+	: queued(0), stopping(false)
+	{
+		for (size_t i = 0; i <= workers; ++i)
+		{
+			queues.emplace_back(new queue);
+		}
+		for (size_t i = 0; i < workers; ++i)
+		{
+			threads.emplace_back(&thread_pool::work, this, i);
+		}
+	}
+
+	thread_pool::~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	size_t thread_pool::size() const
+	{
+		return threads.size();
+	}
+
+	void thread_pool::run(std::function<void()> const* tasks, size_t n)
+	{
+		if (n == 0) return;
+
+		group owner;
+		owner.remaining = n - 1;
+		size_t self = own_queue();
+		queued += n - 1;
+		{
+			std::lock_guard<std::mutex> lock(queues[self]->mutex);
+			for (size_t i = 1; i < n; ++i)
+			{
+				queues[self]->tasks.push_back(task{tasks + i, &owner});
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		wake.notify_all();
+
+		try
+		{
+			tasks[0]();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(owner.mutex);
+			owner.error = std::current_exception();
+		}
+
+		while (owner.remaining != 0)
+		{
+			if (!try_run(self)) std::this_thread::yield();
+		}
+		if (owner.error) std::rethrow_exception(owner.error);
+	}
+
+	size_t thread_pool::own_queue() const
+	{
+		return current_pool == this ? current_queue : threads.size();
+	}
+
+	bool thread_pool::try_run(size_t self)
+	{
+		task next{nullptr, nullptr};
+		{
+			std::lock_guard<std::mutex> lock(queues[self]->mutex);
+			if (!queues[self]->tasks.empty())
+			{
+				next = queues[self]->tasks.back();
+				queues[self]->tasks.pop_back();
+			}
+		}
+		for (size_t i = 1; i < queues.size() && next.function == nullptr; ++i)
+		{
+			queue& victim = *queues[(self + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				next = victim.tasks.front();
+				victim.tasks.pop_front();
+			}
+		}
+		if (next.function == nullptr) return false;
+
+		--queued;
+		try
+		{
+			(*next.function)();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(next.owner->mutex);
+			if (!next.owner->error) next.owner->error = std::current_exception();
+		}
+		// The owner may return as soon as this reaches zero, so it is the last access to it.
+		--next.owner->remaining;
+		return true;
+	}
+
+	void thread_pool::work(size_t index)
+	{
+		current_pool = this;
+		current_queue = index;
+		for (;;)
+		{
+			if (try_run(index)) continue;
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			wake.wait(lock, [this] { return stopping || queued != 0; });
+			if (stopping) return;
+		}
+	}
+
+	void set_thread_count(size_t count)
+	{
+		std::shared_ptr<thread_pool> pool;
+		if (count > 1) pool = std::make_shared<thread_pool>(count - 1);
+
+		std::lock_guard<std::mutex> lock(shared_pool_mutex);
+		shared_pool.swap(pool);
+	}
+
+	size_t thread_count()
+	{
+		std::lock_guard<std::mutex> lock(shared_pool_mutex);
+		return shared_pool ? shared_pool->size() + 1 : 1;
+	}
+
+	void run_parallel(bool parallel, std::initializer_list<std::function<void()>> tasks)
+	{
+		std::shared_ptr<thread_pool> pool;
+		if (parallel)
+		{
+			std::lock_guard<std::mutex> lock(shared_pool_mutex);
+			pool = shared_pool;
+		}
+
+		if (pool)
+		{
+			pool->run(tasks.begin(), tasks.size());
+			return;
+		}
+		for (auto const& task : tasks)
+		{
+			task();
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace limbs
+{
+	// A fork-join pool with work stealing: every worker takes the newest task from its own queue and steals
+	// the oldest one from the others when it runs dry. A thread waiting for its tasks keeps running queued
+	// ones in the meantime, so recursive forks cannot deadlock.
+	struct thread_pool
+	{
+		explicit thread_pool(size_t workers);
+		~thread_pool();
+
+		thread_pool(thread_pool const&) = delete;
+		thread_pool& operator=(thread_pool const&) = delete;
+
+		size_t size() const;
+
+		// Runs the n tasks and returns when all of them are done; rethrows the first exception one of them threw.
+		void run(std::function<void()> const* tasks, size_t n);
+
+	private:
+		struct group
+		{
+			std::atomic<size_t> remaining;
+			std::mutex mutex;
+			std::exception_ptr error;
+		};
+
+		struct task
+		{
+			std::function<void()> const* function;
+			group* owner;
+		};
+
+		struct queue
+		{
+			std::mutex mutex;
+			std::deque<task> tasks;
+		};
+
+		// The queue of the calling thread: its own for a worker, the shared last one for any other thread.
+		size_t own_queue() const;
+		bool try_run(size_t self);
+		void work(size_t index);
+
+		std::vector<std::unique_ptr<queue>> queues;
+		std::vector<std::thread> threads;
+		std::atomic<size_t> queued;
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+		bool stopping;
+	};
+
+	// Runs the tasks on the shared pool if parallel is set and set_thread_count() allowed more than one thread,
+	// one after another on the calling thread otherwise.
+	void run_parallel(bool parallel, std::initializer_list<std::function<void()>> tasks);
+}
@@ -3,6 +3,7 @@
 #include <dlfcn.h>
 #include <string>
 #include <exception>
+#include <stdexcept>
 
 struct dynamic_library
 {
@@ -16,7 +17,7 @@ private:
     void * handle_;
 };
 
-dynamic_library::dynamic_library(std::string const& name)
+inline dynamic_library::dynamic_library(std::string const& name)
 {
     handle_ = dlopen(name.c_str(), RTLD_LAZY);
     if (handle_ == nullptr)
@@ -26,7 +27,7 @@ dynamic_library::dynamic_library(std::string const& name)
     }
 }
 
-dynamic_library::~dynamic_library()
+inline dynamic_library::~dynamic_library()
 {
     dlclose(handle_);
 }